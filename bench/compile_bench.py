@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+# compile_bench.py
+#
+# Compiler throughput benchmarks. Generates stress-shaped Syro programs,
+# compiles each with `syroc -ftime-report=json`, and reports lines per
+# second and peak RSS for every phase. Results are compared against a
+# stored baseline and regressions beyond the tolerance fail the run.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def gen_long_statements(n):
+    lines = ["@main() -> i32 {", "    i32: x = 0;"]
+    lines += ["    x = x + %d;" % (i % 7) for i in range(n)]
+    lines += ["    return x;", "}"]
+    return lines
+
+
+def gen_deep_expressions(n):
+    # One deeply parenthesised expression per statement exercises the
+    # recursion in parse_binary_expression_with_precedence.
+    depth = 200
+    lines = ["@main() -> i32 {", "    i32: x = 1;"]
+    for i in range(max(1, n // depth)):
+        lines.append("    x = " + "(" * depth + "x")
+        for d in range(depth):
+            lines.append("        %s %d)" % ("+-*"[d % 3], (d % 5) + 1))
+        lines.append("        / 1000;")
+    lines += ["    return x;", "}"]
+    return lines
+
+
+def gen_many_functions(n):
+    count = max(1, n // 4)
+    lines = []
+    for i in range(count):
+        lines += [
+            "@f%d(i32: a, i32: b) -> i32 {" % i,
+            "    return a * %d + b;" % (i % 13),
+            "}",
+            "",
+        ]
+    lines += ["@main() -> i32 {", "    print(f0(1, 2));", "    return 0;", "}"]
+    return lines
+
+
+def gen_many_locals(n):
+    lines = ["@main() -> i32 {"]
+    lines += ["    i32: v%d = %d;" % (i, i) for i in range(n)]
+    lines += ["    return v%d;" % (n - 1), "}"]
+    return lines
+
+
+def gen_big_array_init(n):
+    per_array = 1000
+    per_line = 10
+    lines = ["@main() -> i32 {"]
+    for a in range(max(1, n * per_line // per_array)):
+        lines.append("    i32: a%d = {" % a)
+        for row in range(0, per_array, per_line):
+            values = ", ".join(str((a + row + i) % 100) for i in range(per_line))
+            lines.append("        %s%s" % (values, "," if row + per_line < per_array else ""))
+        # Array initializers are not followed by ';' in Syro.
+        lines.append("    }")
+    lines += ["    return 0;", "}"]
+    return lines
+
+
+GENERATORS = {
+    "long_statements": gen_long_statements,
+    "deep_expressions": gen_deep_expressions,
+    "many_functions": gen_many_functions,
+    "many_locals": gen_many_locals,
+    "big_array_init": gen_big_array_init,
+}
+
+
+def run_once(syroc, work_dir, extra_args):
+    result = subprocess.run(
+        [syroc, "-ftime-report=json"] + extra_args,
+        cwd=work_dir,
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    if result.returncode != 0:
+        sys.stderr.write(result.stderr)
+        raise SystemExit("syroc failed")
+    for line in reversed(result.stderr.splitlines()):
+        if line.startswith("{"):
+            return json.loads(line)
+    raise SystemExit("no time report in syroc output")
+
+
+def measure(syroc, name, size, repeats, extra_args):
+    lines = GENERATORS[name](size)
+    with tempfile.TemporaryDirectory() as work_dir:
+        with open(os.path.join(work_dir, "main.syro"), "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+        best = {}
+        peak = 0
+        for _ in range(repeats):
+            report = run_once(syroc, work_dir, extra_args)
+            peak = max(peak, report["peak_rss_kb"])
+            for phase in report["phases"]:
+                wall = phase["wall_ms"]
+                entry = best.setdefault(phase["name"], {"wall_ms": wall, "peak_rss_kb": phase["peak_rss_kb"]})
+                entry["wall_ms"] = min(entry["wall_ms"], wall)
+
+    total_ms = sum(p["wall_ms"] for p in best.values())
+    phases = {}
+    for phase, values in best.items():
+        wall_s = max(values["wall_ms"], 1e-3) / 1000.0
+        phases[phase] = {
+            "wall_ms": round(values["wall_ms"], 3),
+            "lines_per_sec": round(len(lines) / wall_s),
+            "peak_rss_kb": values["peak_rss_kb"],
+        }
+    return {
+        "lines": len(lines),
+        "total_ms": round(total_ms, 3),
+        "lines_per_sec": round(len(lines) / max(total_ms / 1000.0, 1e-6)),
+        "peak_rss_kb": peak,
+        "phases": phases,
+    }
+
+
+def print_results(results):
+    for name, result in results.items():
+        print("%s: %d lines, %.1f ms, %d lines/s, peak RSS %d KB" % (
+            name, result["lines"], result["total_ms"], result["lines_per_sec"], result["peak_rss_kb"]))
+        for phase, values in result["phases"].items():
+            print("    %-10s %10.3f ms %12d lines/s %10d KB" % (
+                phase, values["wall_ms"], values["lines_per_sec"], values["peak_rss_kb"]))
+
+
+def compare(results, baseline, tolerance):
+    regressions = []
+    for name, result in results.items():
+        base = baseline.get("results", {}).get(name)
+        if not base:
+            continue
+        if result["lines"] != base["lines"]:
+            print("note: %s input size differs from baseline; skipping comparison" % name)
+            continue
+
+        if result["lines_per_sec"] < base["lines_per_sec"] * (1 - tolerance):
+            regressions.append("%s: throughput %d -> %d lines/s" % (
+                name, base["lines_per_sec"], result["lines_per_sec"]))
+        if result["peak_rss_kb"] > base["peak_rss_kb"] * (1 + tolerance):
+            regressions.append("%s: peak RSS %d -> %d KB" % (
+                name, base["peak_rss_kb"], result["peak_rss_kb"]))
+
+        for phase, values in result["phases"].items():
+            base_phase = base["phases"].get(phase)
+            # Sub-millisecond phases are too noisy to compare.
+            if not base_phase or base_phase["wall_ms"] < 1.0:
+                continue
+            if values["lines_per_sec"] < base_phase["lines_per_sec"] * (1 - tolerance):
+                regressions.append("%s/%s: throughput %d -> %d lines/s" % (
+                    name, phase, base_phase["lines_per_sec"], values["lines_per_sec"]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--syroc", default="build/syroc")
+    parser.add_argument("--size", type=int, default=20000, help="approximate lines per generated program")
+    parser.add_argument("--repeats", type=int, default=3)
+    parser.add_argument("--baseline", default=os.path.join(os.path.dirname(__file__), "baseline.json"))
+    parser.add_argument("--tolerance", type=float, default=0.20)
+    parser.add_argument("--update-baseline", action="store_true")
+    parser.add_argument("--only", action="append", choices=sorted(GENERATORS))
+    parser.add_argument("syroc_args", nargs="*", help="extra arguments passed to syroc")
+    args = parser.parse_args()
+
+    syroc = os.path.abspath(args.syroc)
+    if not os.access(syroc, os.X_OK):
+        raise SystemExit("syroc not found at %s; run 'make' first" % syroc)
+
+    names = args.only or list(GENERATORS)
+    results = {name: measure(syroc, name, args.size, args.repeats, args.syroc_args) for name in names}
+    print_results(results)
+
+    if args.update_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump({"size": args.size, "syroc_args": args.syroc_args, "results": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % args.baseline)
+        return
+
+    if not os.path.exists(args.baseline):
+        print("no baseline at %s; run 'make bench-baseline' to create one" % args.baseline)
+        return
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    regressions = compare(results, baseline, args.tolerance)
+    if regressions:
+        print("\nREGRESSIONS (tolerance %d%%):" % round(args.tolerance * 100))
+        for regression in regressions:
+            print("  " + regression)
+        sys.exit(1)
+    print("\nno regressions against %s (tolerance %d%%)" % (args.baseline, round(args.tolerance * 100)))
+
+
+if __name__ == "__main__":
+    main()
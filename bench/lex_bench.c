@@ -0,0 +1,169 @@
+// lex_bench.c
+//
+// Lexer microbenchmark. Lexes a generated Syro corpus (or the file given on
+// the command line) several times, on demand with lex_all_tokens and into
+// a token buffer with tokenize, and reports the best throughput of each in
+// MB/s and tokens per second.
+//
+// Usage: lex_bench [--size <MB>] [--repeats <n>] [--threads <n>] [<file>]
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "driver/source.h"
+#include "lexer/intern.h"
+#include "lexer/lexer.h"
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+static void append(Buffer *buffer, const char *format, ...)
+{
+    for (;;)
+    {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+        va_end(args);
+
+        if (written >= 0 && (size_t)written < buffer->capacity - buffer->length)
+        {
+            buffer->length += (size_t)written;
+            return;
+        }
+
+        buffer->capacity = buffer->capacity * 2 + (size_t)written + 1;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        if (!buffer->data)
+        {
+            fprintf(stderr, "Error: Memory allocation failed in append.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// A mix of the shapes real programs have: indented statements, keywords,
+// short and long identifiers, numbers and operators.
+static void generate_corpus(Buffer *buffer, size_t target_bytes)
+{
+    for (int i = 0; buffer->length < target_bytes; ++i)
+    {
+        append(buffer, "@compute_value_%d(i32: first_operand, i32*: output_pointer) -> i32 {\n", i);
+        append(buffer, "    i32: accumulator = %d;\n", i % 97);
+        append(buffer, "    i64: wide_counter = |i64| first_operand;\n");
+        append(buffer, "    i32[8]: table;\n");
+        append(buffer, "    for (i32: k = 0; k < 8; k = k + 1) {\n");
+        append(buffer, "        table[k] = accumulator * k + %d;\n", i % 13);
+        append(buffer, "        if (table[k] >= first_operand) {\n");
+        append(buffer, "            accumulator = accumulator - table[k] / 3;\n");
+        append(buffer, "        } else {\n");
+        append(buffer, "            accumulator = accumulator + 1;\n");
+        append(buffer, "        }\n");
+        append(buffer, "    }\n");
+        append(buffer, "\twhile (accumulator != 0) { accumulator = accumulator / 2; }\n");
+        append(buffer, "    *output_pointer = accumulator;\n");
+        append(buffer, "    print(accumulator);\n");
+        append(buffer, "    return accumulator;\n");
+        append(buffer, "}\n\n");
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    double size_mb = 32;
+    int repeats = 5;
+    int threads = 1;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size_mb = atof(argv[++i]);
+        else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc)
+            repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (argv[i][0] != '-')
+            path = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [--size <MB>] [--repeats <n>] [--threads <n>] [<file>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (repeats < 1)
+        repeats = 1;
+
+    SourceFile file = {0};
+    Buffer buffer = {0};
+    char *source;
+    size_t length;
+    if (path)
+    {
+        open_source_file(&file, path);
+        source = file.data;
+        length = file.length;
+    }
+    else
+    {
+        generate_corpus(&buffer, (size_t)(size_mb * 1024 * 1024));
+        source = buffer.data;
+        length = buffer.length;
+    }
+
+    // The first pass also fills the intern table, so it is not timed.
+    int tokens = lex_all_tokens(source, length);
+
+    double best_stream = 0;
+    double best_buffer = 0;
+    for (int i = 0; i < repeats; ++i)
+    {
+        double start = now_seconds();
+        lex_all_tokens(source, length);
+        double elapsed = now_seconds() - start;
+        if (i == 0 || elapsed < best_stream)
+            best_stream = elapsed;
+
+        int count;
+        start = now_seconds();
+        LexedToken *buffer_tokens = tokenize(source, length, threads, &count);
+        elapsed = now_seconds() - start;
+        free(buffer_tokens);
+        if (i == 0 || elapsed < best_buffer)
+            best_buffer = elapsed;
+        if (count != tokens)
+        {
+            fprintf(stderr, "Error: tokenize produced %d tokens, lex_all_tokens %d.\n", count, tokens);
+            return EXIT_FAILURE;
+        }
+    }
+
+    double megabytes = (double)length / (1024 * 1024);
+    printf("input      %s\n", path ? path : "generated");
+    printf("bytes      %zu\n", length);
+    printf("tokens     %d\n", tokens);
+    printf("%-10s %10s %10s %10s\n", "mode", "best ms", "MB/s", "Mtokens/s");
+    printf("%-10s %10.3f %10.1f %10.2f\n", "stream", best_stream * 1000, megabytes / best_stream,
+           tokens / best_stream / 1e6);
+    printf("%-10s %10.3f %10.1f %10.2f\n", "buffer", best_buffer * 1000, megabytes / best_buffer,
+           tokens / best_buffer / 1e6);
+
+    if (path)
+        close_source_file(&file);
+    free(buffer.data);
+    free_interned_strings();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,48 @@
+#!/bin/sh
+# parse_scaling.sh
+#
+# Compiles a single function whose body is one long statement list at
+# doubling lengths and prints the parse time per statement, taken from the
+# "parse" phase of -ftime-report=json so that code generation and process
+# start-up are left out. With linear-time statement-list construction the
+# per-statement cost stays flat as the block grows.
+#
+# Usage: bench/parse_scaling.sh [syroc] [sizes...]
+
+SYROC=${1:-build/syroc}
+[ $# -gt 0 ] && shift
+SIZES=${*:-"25000 50000 100000 200000"}
+
+case "$SYROC" in
+/*) ;;
+*) SYROC="$(pwd)/$SYROC" ;;
+esac
+
+if [ ! -x "$SYROC" ]; then
+    echo "syroc not found at $SYROC; run 'make' first" >&2
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+printf "%12s %12s %14s\n" "statements" "parse ms" "ns/statement"
+for size in $SIZES; do
+    awk -v n="$size" 'BEGIN {
+        print "@main() -> void {"
+        print "    i32: x = 0;"
+        for (i = 0; i < n; i++)
+            print "    x = x + 1;"
+        print "    return;"
+        print "}"
+    }' > "$WORK_DIR/main.syro"
+
+    report=$(cd "$WORK_DIR" && "$SYROC" -ftime-report=json 2>&1 > /dev/null) || exit 1
+    parse_ms=$(printf "%s\n" "$report" | sed -n 's/.*"name":"parse","wall_ms":\([0-9.]*\).*/\1/p')
+    if [ -z "$parse_ms" ]; then
+        echo "no parse phase in the -ftime-report output of $SYROC" >&2
+        exit 1
+    fi
+
+    awk -v n="$size" -v ms="$parse_ms" 'BEGIN { printf "%12d %12.3f %14.1f\n", n, ms, ms * 1000000 / n }'
+done
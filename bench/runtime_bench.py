@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# runtime_bench.py
+#
+# Runtime benchmarks for generated code. Every kernel in bench/runtime is
+# compiled to a native executable at each optimization level, run several
+# times, and reported as time per iteration. Kernels repeat their workload
+# in an outer `iteration` loop whose bound is read from the source. The
+# printed output must match across levels, so a miscompile fails the run.
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+RUNTIME_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "runtime")
+ITERATION_BOUND = re.compile(r"\biteration\s*<\s*(\d+)")
+
+
+def kernel_iterations(source):
+    match = ITERATION_BOUND.search(source)
+    return int(match.group(1)) if match else 1
+
+
+def compile_kernel(syroc, source_path, work_dir, opt_level):
+    shutil.copyfile(source_path, os.path.join(work_dir, "main.syro"))
+    executable = os.path.join(work_dir, "kernel-O%d" % opt_level)
+    result = subprocess.run([syroc, "-O%d" % opt_level, "-o", executable],
+                            cwd=work_dir, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stderr)
+        raise SystemExit("failed to compile %s at -O%d" % (source_path, opt_level))
+    return executable
+
+
+def run_kernel(executable, repeats):
+    best = None
+    output = None
+    for _ in range(repeats):
+        start = time.perf_counter()
+        result = subprocess.run([executable], stdout=subprocess.PIPE, text=True)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            raise SystemExit("%s exited with status %d" % (executable, result.returncode))
+        output = result.stdout
+        best = elapsed if best is None else min(best, elapsed)
+    return best, output
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Runtime benchmarks for code emitted by syroc.")
+    parser.add_argument("--syroc", default="build/syroc")
+    parser.add_argument("--repeats", type=int, default=5)
+    parser.add_argument("--levels", default="0,1,2,3", help="comma-separated optimization levels")
+    parser.add_argument("kernels", nargs="*", help="kernel names (default: all in bench/runtime)")
+    args = parser.parse_args()
+
+    syroc = os.path.abspath(args.syroc)
+    if not os.access(syroc, os.X_OK):
+        raise SystemExit("syroc not found at %s; run 'make' first" % syroc)
+
+    levels = [int(level) for level in args.levels.split(",")]
+    kernels = args.kernels or sorted(f[:-5] for f in os.listdir(RUNTIME_DIR) if f.endswith(".syro"))
+
+    print("%-14s" % "kernel" + "".join("%14s" % ("-O%d us/iter" % level) for level in levels))
+    failed = False
+    with tempfile.TemporaryDirectory() as work_dir:
+        for kernel in kernels:
+            source_path = os.path.join(RUNTIME_DIR, kernel + ".syro")
+            with open(source_path) as f:
+                iterations = kernel_iterations(f.read())
+
+            row = "%-14s" % kernel
+            reference = None
+            for level in levels:
+                executable = compile_kernel(syroc, source_path, work_dir, level)
+                elapsed, output = run_kernel(executable, args.repeats)
+                if reference is None:
+                    reference = output
+                elif output != reference:
+                    print("%s: output at -O%d differs from -O%d" % (kernel, level, levels[0]), file=sys.stderr)
+                    failed = True
+                row += "%14.1f" % (elapsed * 1e6 / iterations)
+            print(row)
+
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
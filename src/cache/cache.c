@@ -0,0 +1,441 @@
+// cache.c
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include "cache.h"
+
+// Bumped whenever the layout of an entry or the meaning of the key changes.
+#define CACHE_FORMAT "syroc-module-cache-1"
+#define MODULE_EXTENSION ".bc"
+#define FUNCTION_EXTENSION ".fn"
+#define FUNCTION_MAGIC "SYROFN1"
+
+typedef struct
+{
+    char *path;
+    uint64_t size;
+    struct timespec used;
+} CacheEntry;
+
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t length)
+{
+    // 64-bit FNV-1a.
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t hash_string(uint64_t hash, const char *string)
+{
+    // The terminator keeps adjacent fields from running together.
+    return hash_bytes(hash, string, strlen(string) + 1);
+}
+
+static uint64_t hash_target_machine(uint64_t hash, LLVMTargetMachineRef target_machine)
+{
+    char *triple = LLVMGetTargetMachineTriple(target_machine);
+    char *cpu = LLVMGetTargetMachineCPU(target_machine);
+    char *features = LLVMGetTargetMachineFeatureString(target_machine);
+    hash = hash_string(hash, triple);
+    hash = hash_string(hash, cpu);
+    hash = hash_string(hash, features);
+    LLVMDisposeMessage(features);
+    LLVMDisposeMessage(cpu);
+    LLVMDisposeMessage(triple);
+    return hash;
+}
+
+// syroc has no release numbering yet, so the running executable's size and
+// modification time stand in for its version: rebuilding the compiler
+// invalidates every entry it produced.
+static uint64_t hash_compiler_build(uint64_t hash)
+{
+    struct stat info;
+    if (stat("/proc/self/exe", &info) == 0)
+    {
+        hash = hash_bytes(hash, &info.st_size, sizeof(info.st_size));
+        hash = hash_bytes(hash, &info.st_mtim, sizeof(info.st_mtim));
+    }
+    return hash_string(hash, LLVM_VERSION_STRING);
+}
+
+void init_module_cache(ModuleCache *cache, const char *directory, uint64_t max_bytes,
+                       LLVMTargetMachineRef target_machine, int opt_level, int direct_ssa)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->directory = directory;
+    cache->max_bytes = max_bytes;
+
+    uint64_t hash = hash_string(HASH_SEED, CACHE_FORMAT);
+    hash = hash_compiler_build(hash);
+    hash = hash_target_machine(hash, target_machine);
+    hash = hash_bytes(hash, &opt_level, sizeof(opt_level));
+    hash = hash_bytes(hash, &direct_ssa, sizeof(direct_ssa));
+    cache->config_hash = hash;
+
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST)
+        fprintf(stderr, "Warning: Could not create cache directory %s: %s\n", directory, strerror(errno));
+}
+
+uint64_t module_cache_key(ModuleCache *cache, const char *source, size_t length)
+{
+    uint64_t hash = hash_bytes(cache->config_hash, &length, sizeof(length));
+    return hash_bytes(hash, source, length);
+}
+
+static char *entry_path(ModuleCache *cache, uint64_t key, const char *extension, const char *suffix)
+{
+    size_t size = strlen(cache->directory) + 1 + 16 + strlen(extension) + strlen(suffix) + 1;
+    char *path = malloc(size);
+    if (!path)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in entry_path.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, size, "%s/%016llx%s%s", cache->directory, (unsigned long long)key, extension, suffix);
+    return path;
+}
+
+// Entries are written to a private temporary file and renamed into place,
+// so concurrent compilers sharing a directory never see a partial entry.
+static void write_entry(ModuleCache *cache, uint64_t key, const char *extension,
+                        const void *header, size_t header_size, LLVMModuleRef module)
+{
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".tmp.%ld", (long)getpid());
+    char *temporary_path = entry_path(cache, key, extension, suffix);
+    char *path = entry_path(cache, key, extension, "");
+
+    LLVMMemoryBufferRef bitcode = LLVMWriteBitcodeToMemoryBuffer(module);
+    size_t size = LLVMGetBufferSize(bitcode);
+
+    FILE *file = fopen(temporary_path, "wb");
+    int written = file && fwrite(header, 1, header_size, file) == header_size &&
+                  fwrite(LLVMGetBufferStart(bitcode), 1, size, file) == size;
+    if (file && fclose(file) != 0)
+        written = 0;
+
+    if (written && rename(temporary_path, path) == 0)
+    {
+        cache->stores++;
+        cache->bytes_written += header_size + size;
+    }
+    else
+    {
+        fprintf(stderr, "Warning: Could not write cache entry %s.\n", path);
+        unlink(temporary_path);
+    }
+
+    LLVMDisposeMemoryBuffer(bitcode);
+    free(path);
+    free(temporary_path);
+}
+
+LLVMModuleRef module_cache_lookup(ModuleCache *cache, uint64_t key, LLVMContextRef context)
+{
+    char *path = entry_path(cache, key, MODULE_EXTENSION, "");
+    LLVMMemoryBufferRef bitcode;
+    char *error = NULL;
+    if (LLVMCreateMemoryBufferWithContentsOfFile(path, &bitcode, &error))
+    {
+        LLVMDisposeMessage(error);
+        free(path);
+        cache->misses++;
+        return NULL;
+    }
+
+    size_t size = LLVMGetBufferSize(bitcode);
+    LLVMModuleRef module;
+    if (LLVMParseBitcodeInContext2(context, bitcode, &module))
+    {
+        // A truncated or foreign file is dropped and rebuilt.
+        LLVMDisposeMemoryBuffer(bitcode);
+        unlink(path);
+        free(path);
+        cache->misses++;
+        return NULL;
+    }
+    LLVMDisposeMemoryBuffer(bitcode);
+
+    // The parsed module is named after the cache file; a hit has to print
+    // the same IR as the fresh build it replaces.
+    LLVMSetModuleIdentifier(module, "module", strlen("module"));
+
+    // The modification time doubles as the last-use time for eviction.
+    utimensat(AT_FDCWD, path, NULL, 0);
+    free(path);
+
+    cache->hits++;
+    cache->bytes_read += size;
+    return module;
+}
+
+void module_cache_store(ModuleCache *cache, uint64_t key, LLVMModuleRef module)
+{
+    write_entry(cache, key, MODULE_EXTENSION, NULL, 0, module);
+}
+
+// Function entries are keyed by where the source lives rather than what it
+// contains, so an edited file finds the entry its previous version left.
+uint64_t function_cache_key(ModuleCache *cache, const char *input_path)
+{
+    char *resolved = realpath(input_path, NULL);
+    uint64_t hash = hash_string(cache->config_hash, FUNCTION_MAGIC);
+    hash = hash_string(hash, resolved ? resolved : input_path);
+    free(resolved);
+    return hash;
+}
+
+static int read_header_field(const char **cursor, const char *end, void *field, size_t size)
+{
+    if ((size_t)(end - *cursor) < size)
+        return 0;
+    memcpy(field, *cursor, size);
+    *cursor += size;
+    return 1;
+}
+
+// The entry is the magic, a fingerprint count, each fingerprint and its
+// name, and then the module bitcode.
+static int parse_function_header(const char **cursor, const char *end,
+                                 FunctionFingerprint **fingerprints, int *fingerprint_count)
+{
+    char magic[sizeof(FUNCTION_MAGIC)];
+    uint32_t count;
+    if (!read_header_field(cursor, end, magic, sizeof(magic)) || memcmp(magic, FUNCTION_MAGIC, sizeof(magic)) != 0 ||
+        !read_header_field(cursor, end, &count, sizeof(count)) || count > (size_t)(end - *cursor))
+        return 0;
+
+    FunctionFingerprint *entries = calloc(count ? count : 1, sizeof(FunctionFingerprint));
+    if (!entries)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in parse_function_header.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t name_length;
+        if (!read_header_field(cursor, end, &entries[i].fingerprint, sizeof(uint64_t)) ||
+            !read_header_field(cursor, end, &name_length, sizeof(name_length)) ||
+            name_length > (size_t)(end - *cursor))
+        {
+            free_function_fingerprints(entries, (int)i);
+            return 0;
+        }
+        entries[i].name = strndup(*cursor, name_length);
+        *cursor += name_length;
+    }
+
+    *fingerprints = entries;
+    *fingerprint_count = (int)count;
+    return 1;
+}
+
+LLVMModuleRef function_cache_lookup(ModuleCache *cache, uint64_t key, LLVMContextRef context,
+                                    FunctionFingerprint **fingerprints, int *fingerprint_count)
+{
+    char *path = entry_path(cache, key, FUNCTION_EXTENSION, "");
+    LLVMMemoryBufferRef contents;
+    char *error = NULL;
+    if (LLVMCreateMemoryBufferWithContentsOfFile(path, &contents, &error))
+    {
+        LLVMDisposeMessage(error);
+        free(path);
+        return NULL;
+    }
+
+    size_t size = LLVMGetBufferSize(contents);
+    const char *cursor = LLVMGetBufferStart(contents);
+    const char *end = cursor + size;
+    LLVMModuleRef module = NULL;
+    if (parse_function_header(&cursor, end, fingerprints, fingerprint_count))
+    {
+        LLVMMemoryBufferRef bitcode = LLVMCreateMemoryBufferWithMemoryRange(cursor, end - cursor, path, 0);
+        if (LLVMParseBitcodeInContext2(context, bitcode, &module))
+        {
+            module = NULL;
+            free_function_fingerprints(*fingerprints, *fingerprint_count);
+        }
+        LLVMDisposeMemoryBuffer(bitcode);
+    }
+    LLVMDisposeMemoryBuffer(contents);
+
+    if (!module)
+    {
+        unlink(path);
+        free(path);
+        return NULL;
+    }
+
+    // As in module_cache_lookup, the module must not be named after the file.
+    LLVMSetModuleIdentifier(module, "module", strlen("module"));
+
+    utimensat(AT_FDCWD, path, NULL, 0);
+    free(path);
+    cache->bytes_read += size;
+    return module;
+}
+
+void function_cache_store(ModuleCache *cache, uint64_t key, LLVMModuleRef module,
+                          FunctionFingerprint *fingerprints, int fingerprint_count)
+{
+    size_t header_size = sizeof(FUNCTION_MAGIC) + sizeof(uint32_t);
+    for (int i = 0; i < fingerprint_count; ++i)
+        header_size += sizeof(uint64_t) + sizeof(uint32_t) + strlen(fingerprints[i].name);
+
+    char *header = malloc(header_size);
+    if (!header)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in function_cache_store.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char *cursor = header;
+    uint32_t count = (uint32_t)fingerprint_count;
+    memcpy(cursor, FUNCTION_MAGIC, sizeof(FUNCTION_MAGIC));
+    cursor += sizeof(FUNCTION_MAGIC);
+    memcpy(cursor, &count, sizeof(count));
+    cursor += sizeof(count);
+    for (int i = 0; i < fingerprint_count; ++i)
+    {
+        uint32_t name_length = (uint32_t)strlen(fingerprints[i].name);
+        memcpy(cursor, &fingerprints[i].fingerprint, sizeof(uint64_t));
+        cursor += sizeof(uint64_t);
+        memcpy(cursor, &name_length, sizeof(name_length));
+        cursor += sizeof(name_length);
+        memcpy(cursor, fingerprints[i].name, name_length);
+        cursor += name_length;
+    }
+
+    write_entry(cache, key, FUNCTION_EXTENSION, header, header_size, module);
+    free(header);
+}
+
+static int compare_entries_by_use(const void *a, const void *b)
+{
+    const CacheEntry *left = (const CacheEntry *)a;
+    const CacheEntry *right = (const CacheEntry *)b;
+    if (left->used.tv_sec != right->used.tv_sec)
+        return left->used.tv_sec < right->used.tv_sec ? -1 : 1;
+    if (left->used.tv_nsec != right->used.tv_nsec)
+        return left->used.tv_nsec < right->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+static int has_extension(const char *name, const char *extension)
+{
+    size_t length = strlen(name);
+    size_t extension_length = strlen(extension);
+    return length > extension_length && strcmp(name + length - extension_length, extension) == 0;
+}
+
+static int is_cache_entry(const char *name)
+{
+    return has_extension(name, MODULE_EXTENSION) || has_extension(name, FUNCTION_EXTENSION);
+}
+
+// Deletes least recently used entries until the directory fits in max_bytes.
+void module_cache_evict(ModuleCache *cache)
+{
+    DIR *directory = opendir(cache->directory);
+    if (!directory)
+        return;
+
+    int entry_count = 0;
+    int entry_capacity = 64;
+    CacheEntry *entries = malloc(sizeof(CacheEntry) * entry_capacity);
+    if (!entries)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in module_cache_evict.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t total_bytes = 0;
+    struct dirent *dirent;
+    while ((dirent = readdir(directory)) != NULL)
+    {
+        if (!is_cache_entry(dirent->d_name))
+            continue;
+
+        size_t path_size = strlen(cache->directory) + 1 + strlen(dirent->d_name) + 1;
+        char *path = malloc(path_size);
+        if (!path)
+        {
+            fprintf(stderr, "Error: Memory allocation failed in module_cache_evict.\n");
+            exit(EXIT_FAILURE);
+        }
+        snprintf(path, path_size, "%s/%s", cache->directory, dirent->d_name);
+
+        struct stat info;
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode))
+        {
+            free(path);
+            continue;
+        }
+
+        if (entry_count == entry_capacity)
+        {
+            entry_capacity *= 2;
+            entries = realloc(entries, sizeof(CacheEntry) * entry_capacity);
+            if (!entries)
+            {
+                fprintf(stderr, "Error: Memory allocation failed in module_cache_evict.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        entries[entry_count].path = path;
+        entries[entry_count].size = (uint64_t)info.st_size;
+        entries[entry_count].used = info.st_mtim;
+        entry_count++;
+        total_bytes += (uint64_t)info.st_size;
+    }
+    closedir(directory);
+
+    if (total_bytes > cache->max_bytes)
+    {
+        qsort(entries, entry_count, sizeof(CacheEntry), compare_entries_by_use);
+        for (int i = 0; i < entry_count && total_bytes > cache->max_bytes; ++i)
+        {
+            if (unlink(entries[i].path) != 0)
+                continue;
+            total_bytes -= entries[i].size;
+            cache->evictions++;
+            cache->bytes_evicted += entries[i].size;
+        }
+    }
+
+    for (int i = 0; i < entry_count; ++i)
+        free(entries[i].path);
+    free(entries);
+}
+
+void print_cache_statistics(ModuleCache *cache, FILE *out)
+{
+    fprintf(out, "===== syroc cache statistics =====\n");
+    fprintf(out, "%-20s %s\n", "directory", cache->directory);
+    fprintf(out, "%-20s %zu\n", "hits", cache->hits);
+    fprintf(out, "%-20s %zu\n", "misses", cache->misses);
+    fprintf(out, "%-20s %zu\n", "stores", cache->stores);
+    fprintf(out, "%-20s %zu\n", "evictions", cache->evictions);
+    fprintf(out, "%-20s %zu\n", "functions reused", cache->functions_reused);
+    fprintf(out, "%-20s %zu\n", "functions generated", cache->functions_generated);
+    fprintf(out, "%-20s %llu\n", "bytes read", (unsigned long long)cache->bytes_read);
+    fprintf(out, "%-20s %llu\n", "bytes written", (unsigned long long)cache->bytes_written);
+    fprintf(out, "%-20s %llu\n", "bytes evicted", (unsigned long long)cache->bytes_evicted);
+    fprintf(out, "%-20s %llu\n", "max bytes", (unsigned long long)cache->max_bytes);
+}
@@ -0,0 +1,57 @@
+// cache.h
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+#include "fingerprint.h"
+
+#define DEFAULT_CACHE_MAX_BYTES (512ull * 1024 * 1024)
+#define HASH_SEED 0xcbf29ce484222325ull
+
+// Content-addressed on-disk cache of optimized module bitcode. An entry is
+// keyed by a hash of the source text, the compiler build and every flag
+// that affects the generated code, so a hit can skip the front end,
+// codegen and the optimizer. The least recently used entries are evicted
+// once the directory grows past max_bytes.
+//
+// Alongside, each input path keeps one function entry: its most recent
+// unoptimized module plus the fingerprint of every function in it, from
+// which unchanged functions are reused when the file is edited.
+typedef struct
+{
+    const char *directory;
+    uint64_t max_bytes;
+    uint64_t config_hash;
+    size_t hits;
+    size_t misses;
+    size_t stores;
+    size_t evictions;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t bytes_evicted;
+    size_t functions_reused;
+    size_t functions_generated;
+} ModuleCache;
+
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t length);
+uint64_t hash_string(uint64_t hash, const char *string);
+
+void init_module_cache(ModuleCache *cache, const char *directory, uint64_t max_bytes,
+                       LLVMTargetMachineRef target_machine, int opt_level, int direct_ssa);
+uint64_t module_cache_key(ModuleCache *cache, const char *source, size_t length);
+LLVMModuleRef module_cache_lookup(ModuleCache *cache, uint64_t key, LLVMContextRef context);
+void module_cache_store(ModuleCache *cache, uint64_t key, LLVMModuleRef module);
+uint64_t function_cache_key(ModuleCache *cache, const char *input_path);
+LLVMModuleRef function_cache_lookup(ModuleCache *cache, uint64_t key, LLVMContextRef context,
+                                    FunctionFingerprint **fingerprints, int *fingerprint_count);
+void function_cache_store(ModuleCache *cache, uint64_t key, LLVMModuleRef module,
+                          FunctionFingerprint *fingerprints, int fingerprint_count);
+void module_cache_evict(ModuleCache *cache);
+void print_cache_statistics(ModuleCache *cache, FILE *out);
+
+#endif // CACHE_H
@@ -0,0 +1,257 @@
+// fingerprint.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <error.h>
+#include "cache.h"
+#include "fingerprint.h"
+
+// Maps each top-level function name (an interned pointer) to a hash of its
+// signature, so a call can be keyed on what its callee looks like without
+// depending on the callee's body.
+typedef struct
+{
+    char **names;
+    uint64_t *signatures;
+    int capacity;
+} SignatureTable;
+
+static unsigned int hash_name(const char *name)
+{
+    uintptr_t address = (uintptr_t)name;
+    return (unsigned int)((address >> 3) * 2654435761u);
+}
+
+static uint64_t hash_int(uint64_t hash, int value)
+{
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t hash_type(uint64_t hash, Type *type)
+{
+    if (!type)
+        return hash_int(hash, -1);
+
+    hash = hash_int(hash, type->kind);
+    switch (type->kind)
+    {
+    case TYPE_INTEGER:
+        return hash_int(hash, type->width);
+    case TYPE_POINTER:
+        return hash_type(hash, type->pointee);
+    case TYPE_ARRAY:
+        return hash_type(hash_int(hash, type->length), type->element);
+    default:
+        return hash;
+    }
+}
+
+static uint64_t hash_signature(uint64_t hash, Node *function)
+{
+    hash = hash_type(hash, function->as.function_decl.return_type);
+    hash = hash_int(hash, function->as.function_decl.param_count);
+    for (int i = 0; i < function->as.function_decl.param_count; ++i)
+        hash = hash_type(hash, function->as.function_decl.parameters[i]->as.variable_decl.type);
+    return hash;
+}
+
+static void init_signature_table(SignatureTable *table, Node *program)
+{
+    int function_count = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+        function_count += entry->as.statement_list.statement->type == AST_FUNCTION_DECL;
+
+    table->capacity = 16;
+    while (table->capacity < function_count * 2)
+        table->capacity *= 2;
+    table->names = calloc(table->capacity, sizeof(char *));
+    table->signatures = malloc(sizeof(uint64_t) * table->capacity);
+    if (!table->names || !table->signatures)
+    {
+        error_report(-1, "Memory allocation failed in init_signature_table.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // The first declaration of a name wins, as it does in codegen.
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+    {
+        Node *statement = entry->as.statement_list.statement;
+        if (statement->type != AST_FUNCTION_DECL)
+            continue;
+
+        unsigned int index = hash_name(statement->as.function_decl.name) & mask;
+        while (table->names[index] && table->names[index] != statement->as.function_decl.name)
+            index = (index + 1) & mask;
+        if (table->names[index])
+            continue;
+        table->names[index] = statement->as.function_decl.name;
+        table->signatures[index] = hash_signature(HASH_SEED, statement);
+    }
+}
+
+static uint64_t lookup_signature(SignatureTable *table, char *name)
+{
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int index = hash_name(name) & mask;
+    while (table->names[index])
+    {
+        if (table->names[index] == name)
+            return table->signatures[index];
+        index = (index + 1) & mask;
+    }
+    return 0;
+}
+
+static void free_signature_table(SignatureTable *table)
+{
+    free(table->names);
+    free(table->signatures);
+}
+
+// Hashes every field codegen reads, in a fixed order. Names are hashed by
+// content since interned pointers differ from one run to the next.
+static uint64_t hash_node(uint64_t hash, Node *node, SignatureTable *signatures)
+{
+    if (!node)
+        return hash_int(hash, -1);
+
+    hash = hash_int(hash, node->type);
+    switch (node->type)
+    {
+    case AST_NUMBER:
+        return hash_int(hash, node->as.number);
+    case AST_IDENTIFIER:
+        return hash_string(hash, node->as.name);
+    case AST_ASSIGNMENT:
+        hash = hash_string(hash, node->as.assignment.name);
+        return hash_node(hash, node->as.assignment.value, signatures);
+    case AST_PLUS:
+    case AST_MINUS:
+    case AST_STAR:
+    case AST_SLASH:
+    case AST_SHIFT_LEFT:
+    case AST_EQUAL_EQUAL:
+    case AST_BANG_EQUAL:
+    case AST_LESS:
+    case AST_LESS_EQUAL:
+    case AST_GREATER:
+    case AST_GREATER_EQUAL:
+        hash = hash_node(hash, node->as.binary.left, signatures);
+        return hash_node(hash, node->as.binary.right, signatures);
+    case AST_ADDRESS_OF:
+    case AST_NEGATE:
+    case AST_DEREFERENCE:
+    case AST_PRINT:
+    case AST_RETURN_STMT:
+    case AST_BLOCK:
+        return hash_node(hash, node->as.operand, signatures);
+    case AST_DEREFERENCE_ASSIGNMENT:
+        hash = hash_node(hash, node->as.dereference_assignment.target, signatures);
+        return hash_node(hash, node->as.dereference_assignment.value, signatures);
+    case AST_VARIABLE_DECL:
+        hash = hash_type(hash, node->as.variable_decl.type);
+        hash = hash_string(hash, node->as.variable_decl.name);
+        return hash_node(hash, node->as.variable_decl.initializer, signatures);
+    case AST_ARRAY_DECL:
+        hash = hash_string(hash, node->as.array_decl.name);
+        hash = hash_type(hash, node->as.array_decl.element_type);
+        hash = hash_int(hash, node->as.array_decl.length);
+        hash = hash_int(hash, node->as.array_decl.element_count);
+        for (int i = 0; i < node->as.array_decl.element_count; ++i)
+            hash = hash_node(hash, node->as.array_decl.elements[i], signatures);
+        return hash;
+    case AST_ARRAY_ACCESS:
+        hash = hash_string(hash, node->as.array_access.name);
+        return hash_node(hash, node->as.array_access.index, signatures);
+    case AST_ARRAY_ASSIGNMENT:
+        hash = hash_string(hash, node->as.array_assignment.name);
+        hash = hash_node(hash, node->as.array_assignment.index, signatures);
+        return hash_node(hash, node->as.array_assignment.value, signatures);
+    case AST_FUNCTION_CALL:
+    {
+        uint64_t callee_signature = lookup_signature(signatures, node->as.function_call.name);
+        hash = hash_string(hash, node->as.function_call.name);
+        hash = hash_bytes(hash, &callee_signature, sizeof(callee_signature));
+        hash = hash_int(hash, node->as.function_call.arg_count);
+        for (int i = 0; i < node->as.function_call.arg_count; ++i)
+            hash = hash_node(hash, node->as.function_call.arguments[i], signatures);
+        return hash;
+    }
+    case AST_FUNCTION_DECL:
+        hash = hash_string(hash, node->as.function_decl.name);
+        hash = hash_signature(hash, node);
+        for (int i = 0; i < node->as.function_decl.param_count; ++i)
+            hash = hash_string(hash, node->as.function_decl.parameters[i]->as.variable_decl.name);
+        return hash_node(hash, node->as.function_decl.body, signatures);
+    case AST_STATEMENT_LIST:
+        for (Node *entry = node; entry != NULL; entry = entry->as.statement_list.next)
+            hash = hash_node(hash, entry->as.statement_list.statement, signatures);
+        return hash_int(hash, -2);
+    case AST_CAST:
+        hash = hash_type(hash, node->as.cast.type);
+        return hash_node(hash, node->as.cast.expression, signatures);
+    case AST_IF_STATEMENT:
+        hash = hash_node(hash, node->as.if_statement.condition, signatures);
+        hash = hash_node(hash, node->as.if_statement.then_branch, signatures);
+        return hash_node(hash, node->as.if_statement.else_branch, signatures);
+    case AST_WHILE_STATEMENT:
+        hash = hash_node(hash, node->as.while_statement.condition, signatures);
+        return hash_node(hash, node->as.while_statement.body, signatures);
+    case AST_FOR_STATEMENT:
+        hash = hash_node(hash, node->as.for_statement.init, signatures);
+        hash = hash_node(hash, node->as.for_statement.condition, signatures);
+        hash = hash_node(hash, node->as.for_statement.increment, signatures);
+        return hash_node(hash, node->as.for_statement.body, signatures);
+    default:
+        error_report(-1, "Unknown node type %d in hash_node.\n", node->type);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Returns one fingerprint per top-level function definition, in source
+// order. Prototypes have no code of their own and are skipped.
+FunctionFingerprint *fingerprint_functions(Node *program, uint64_t seed, int *count)
+{
+    SignatureTable signatures;
+    init_signature_table(&signatures, program);
+
+    int capacity = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+        capacity += entry->as.statement_list.statement->type == AST_FUNCTION_DECL;
+
+    FunctionFingerprint *fingerprints = malloc(sizeof(FunctionFingerprint) * (capacity ? capacity : 1));
+    if (!fingerprints)
+    {
+        error_report(-1, "Memory allocation failed in fingerprint_functions.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    *count = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+    {
+        Node *statement = entry->as.statement_list.statement;
+        if (statement->type != AST_FUNCTION_DECL || statement->as.function_decl.is_prototype)
+            continue;
+
+        FunctionFingerprint *fingerprint = &fingerprints[(*count)++];
+        fingerprint->name = strdup(statement->as.function_decl.name);
+        fingerprint->fingerprint = hash_node(seed, statement, &signatures);
+        if (!fingerprint->name)
+        {
+            error_report(-1, "Memory allocation failed in fingerprint_functions.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    free_signature_table(&signatures);
+    return fingerprints;
+}
+
+void free_function_fingerprints(FunctionFingerprint *fingerprints, int count)
+{
+    for (int i = 0; i < count; ++i)
+        free(fingerprints[i].name);
+    free(fingerprints);
+}
@@ -0,0 +1,22 @@
+// fingerprint.h
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <stdint.h>
+#include <parser/ast.h>
+
+// Identifies the code generated for one function definition: a structural
+// hash of its AST_FUNCTION_DECL subtree combined with the signatures of the
+// functions it calls. Equal fingerprints under the same cache configuration
+// mean equal unoptimized IR.
+typedef struct
+{
+    char *name;
+    uint64_t fingerprint;
+} FunctionFingerprint;
+
+FunctionFingerprint *fingerprint_functions(Node *program, uint64_t seed, int *count);
+void free_function_fingerprints(FunctionFingerprint *fingerprints, int count);
+
+#endif // FINGERPRINT_H
@@ -8,80 +8,597 @@
 #include <error.h>
 #include "codegen.h"
 
-LLVMTypeRef get_llvm_type(const char *type_name)
+void init_codegen(CodeGen *codegen, LLVMModuleRef module)
 {
-    if (strchr(type_name, '*') != NULL)
+    codegen->module = module;
+    codegen->context = LLVMGetModuleContext(module);
+    codegen->type_cache = NULL;
+    codegen->type_cache_size = 0;
+    codegen->direct_ssa = 1;
+    codegen->alloca_builder = LLVMCreateBuilderInContext(codegen->context);
+    codegen->last_alloca = NULL;
+    codegen->address_taken = NULL;
+    codegen->address_taken_count = 0;
+}
+
+// Runtime routines are declared on first use. A module being regenerated
+// incrementally may already declare them, so existing declarations are
+// reused rather than duplicated.
+static LLVMValueRef get_runtime_function(CodeGen *codegen, const char *name, LLVMTypeRef param_type)
+{
+    LLVMValueRef func = LLVMGetNamedFunction(codegen->module, name);
+    if (func)
+        return func;
+
+    LLVMTypeRef func_type = LLVMFunctionType(LLVMVoidTypeInContext(codegen->context), &param_type, 1, 0);
+    return LLVMAddFunction(codegen->module, name, func_type);
+}
+
+void dispose_codegen(CodeGen *codegen)
+{
+    LLVMDisposeBuilder(codegen->alloca_builder);
+    codegen->alloca_builder = NULL;
+    free(codegen->type_cache);
+    codegen->type_cache = NULL;
+    codegen->type_cache_size = 0;
+}
+
+LLVMTypeRef get_llvm_type(CodeGen *codegen, Type *type)
+{
+    if (type->id < codegen->type_cache_size && codegen->type_cache[type->id])
+        return codegen->type_cache[type->id];
+
+    LLVMTypeRef llvm_type;
+    switch (type->kind)
+    {
+    case TYPE_VOID:
+        llvm_type = LLVMVoidTypeInContext(codegen->context);
+        break;
+    case TYPE_INTEGER:
+        llvm_type = LLVMIntTypeInContext(codegen->context, type->width);
+        break;
+    case TYPE_POINTER:
+        llvm_type = LLVMPointerType(get_llvm_type(codegen, type->pointee), 0);
+        break;
+    case TYPE_ARRAY:
+        llvm_type = LLVMArrayType(get_llvm_type(codegen, type->element), type->length);
+        break;
+    default:
+        error_report(-1, "Unsupported type kind %d.\n", type->kind);
+        exit(EXIT_FAILURE);
+    }
+
+    if (type->id >= codegen->type_cache_size)
     {
-        int ptr_count = 0;
-        const char *ptr = type_name;
-        while (*ptr == '*')
+        int size = type_count();
+        LLVMTypeRef *cache = realloc(codegen->type_cache, sizeof(LLVMTypeRef) * size);
+        if (!cache)
         {
-            ptr_count++;
-            ptr++;
+            error_report(-1, "Memory allocation failed in get_llvm_type.\n");
+            exit(EXIT_FAILURE);
         }
+        for (int i = codegen->type_cache_size; i < size; ++i)
+            cache[i] = NULL;
+        codegen->type_cache = cache;
+        codegen->type_cache_size = size;
+    }
+    codegen->type_cache[type->id] = llvm_type;
 
-        char *base_type_name = strndup(type_name, strlen(type_name) - ptr_count);
-        LLVMTypeRef base_type = get_llvm_type(base_type_name);
-        free(base_type_name);
+    return llvm_type;
+}
 
-        LLVMTypeRef ptr_type = base_type;
-        for (int i = 0; i < ptr_count; ++i)
-        {
-            ptr_type = LLVMPointerType(ptr_type, 0);
-        }
+static LLVMValueRef declare_function(CodeGen *codegen, Node *node)
+{
+    LLVMTypeRef return_type = LLVMVoidTypeInContext(codegen->context);
+    if (node->as.function_decl.return_type)
+    {
+        return_type = get_llvm_type(codegen, node->as.function_decl.return_type);
+    }
 
-        return ptr_type;
+    // A void main is the C entry point of an executable, so it returns an
+    // exit status of 0 like it does under --run.
+    if (LLVMGetTypeKind(return_type) == LLVMVoidTypeKind && strcmp(node->as.function_decl.name, "main") == 0)
+    {
+        return_type = LLVMInt32TypeInContext(codegen->context);
     }
-    else if (strchr(type_name, '[') != NULL)
+
+    LLVMTypeRef *param_types = malloc(sizeof(LLVMTypeRef) * node->as.function_decl.param_count);
+    for (int i = 0; i < node->as.function_decl.param_count; ++i)
+    {
+        param_types[i] = get_llvm_type(codegen, node->as.function_decl.parameters[i]->as.variable_decl.type);
+    }
+
+    LLVMTypeRef func_type = LLVMFunctionType(return_type, param_types, node->as.function_decl.param_count, 0);
+    free(param_types);
+
+    LLVMValueRef func = LLVMGetNamedFunction(codegen->module, node->as.function_decl.name);
+    if (func)
     {
-        char *element_type_str = strdup(type_name);
-        if (!element_type_str)
+        if (LLVMGlobalGetValueType(func) != func_type)
         {
-            error_report(-1, "Memory allocation failed in get_llvm_type.\n");
+            error_report(-1, "Conflicting declarations of function '%s'.\n", node->as.function_decl.name);
             exit(EXIT_FAILURE);
         }
+        return func;
+    }
+
+    return LLVMAddFunction(codegen->module, node->as.function_decl.name, func_type);
+}
+
+// Declares every top-level function before any body is generated, so calls
+// may refer to functions defined later in the file, and a module generated
+// for a subset of the functions can still call the rest.
+void declare_functions(CodeGen *codegen, Node *program)
+{
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+    {
+        Node *statement = entry->as.statement_list.statement;
+        if (statement->type == AST_FUNCTION_DECL)
+            declare_function(codegen, statement);
+    }
+}
 
-        char *bracket_pos = strchr(element_type_str, '[');
-        *bracket_pos = '\0';
-        char *size_str = bracket_pos + 1;
-        char *end_bracket = strchr(size_str, ']');
-        if (!end_bracket)
+static int compare_values(const void *a, const void *b)
+{
+    LLVMValueRef left = *(const LLVMValueRef *)a;
+    LLVMValueRef right = *(const LLVMValueRef *)b;
+    return left < right ? -1 : left > right;
+}
+
+static int compare_function_names(const void *a, const void *b)
+{
+    size_t length;
+    return strcmp(LLVMGetValueName2(*(const LLVMValueRef *)a, &length),
+                  LLVMGetValueName2(*(const LLVMValueRef *)b, &length));
+}
+
+// Moves `func` to the end of the module's function list. LLVM-C cannot
+// reorder functions, so a new function takes over the arguments, the body
+// and the uses of the old one, and then its name.
+static void move_function_to_end(LLVMModuleRef module, LLVMValueRef func)
+{
+    size_t length;
+    char *name = strdup(LLVMGetValueName2(func, &length));
+    if (!name)
+    {
+        error_report(-1, "Memory allocation failed in move_function_to_end.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LLVMValueRef moved = LLVMAddFunction(module, "", LLVMGlobalGetValueType(func));
+    for (unsigned i = 0; i < LLVMCountParams(func); ++i)
+    {
+        size_t param_length;
+        const char *param_name = LLVMGetValueName2(LLVMGetParam(func, i), &param_length);
+        LLVMSetValueName2(LLVMGetParam(moved, i), param_name, param_length);
+        LLVMReplaceAllUsesWith(LLVMGetParam(func, i), LLVMGetParam(moved, i));
+    }
+
+    if (LLVMCountBasicBlocks(func) > 0)
+    {
+        LLVMBasicBlockRef anchor = LLVMAppendBasicBlockInContext(LLVMGetModuleContext(module), moved, "");
+        LLVMBasicBlockRef block;
+        while ((block = LLVMGetFirstBasicBlock(func)) != NULL)
+            LLVMMoveBasicBlockBefore(block, anchor);
+        LLVMDeleteBasicBlock(anchor);
+    }
+
+    LLVMReplaceAllUsesWith(func, moved);
+    LLVMDeleteFunction(func);
+    LLVMSetValueName2(moved, name, length);
+    free(name);
+}
+
+// Puts the module's functions in a canonical order: the program's functions
+// in the order they are first declared, then the rest, such as runtime
+// routines, by name. A module regenerated incrementally then prints the
+// same IR as one generated from scratch. Functions that are already in
+// place are left alone, so a fresh module only moves its runtime
+// declarations.
+void order_functions(LLVMModuleRef module, Node *program)
+{
+    int capacity = 1;
+    for (LLVMValueRef func = LLVMGetFirstFunction(module); func != NULL; func = LLVMGetNextFunction(func))
+        capacity++;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+        capacity++;
+
+    LLVMValueRef *source = malloc(sizeof(LLVMValueRef) * capacity);
+    LLVMValueRef *sorted = malloc(sizeof(LLVMValueRef) * capacity);
+    LLVMValueRef *others = malloc(sizeof(LLVMValueRef) * capacity);
+    char *seen = calloc(capacity, 1);
+    if (!source || !sorted || !others || !seen)
+    {
+        error_report(-1, "Memory allocation failed in order_functions.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int declared_count = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+    {
+        Node *statement = entry->as.statement_list.statement;
+        if (statement->type != AST_FUNCTION_DECL)
+            continue;
+        LLVMValueRef func = LLVMGetNamedFunction(module, statement->as.function_decl.name);
+        if (func)
+            source[declared_count++] = func;
+    }
+    memcpy(sorted, source, sizeof(LLVMValueRef) * declared_count);
+    qsort(sorted, declared_count, sizeof(LLVMValueRef), compare_values);
+
+    // A prototype and the definition after it are one function, placed
+    // where the prototype is.
+    int source_count = 0;
+    for (int i = 0; i < declared_count; ++i)
+    {
+        LLVMValueRef *match = bsearch(&source[i], sorted, declared_count, sizeof(LLVMValueRef), compare_values);
+        while (match > sorted && match[-1] == source[i])
+            match--;
+        if (seen[match - sorted])
+            continue;
+        seen[match - sorted] = 1;
+        source[source_count++] = source[i];
+    }
+
+    // The other functions are collected before anything moves, because a
+    // moved function is a new value.
+    int other_count = 0;
+    for (LLVMValueRef func = LLVMGetFirstFunction(module); func != NULL; func = LLVMGetNextFunction(func))
+    {
+        if (!bsearch(&func, sorted, declared_count, sizeof(LLVMValueRef), compare_values))
+            others[other_count++] = func;
+    }
+    qsort(others, other_count, sizeof(LLVMValueRef), compare_function_names);
+
+    int in_place = 0;
+    for (LLVMValueRef func = LLVMGetFirstFunction(module); in_place < source_count && func == source[in_place];
+         func = LLVMGetNextFunction(func))
+        in_place++;
+    for (int i = in_place; i < source_count; ++i)
+        move_function_to_end(module, source[i]);
+    for (int i = 0; i < other_count; ++i)
+        move_function_to_end(module, others[i]);
+
+    free(source);
+    free(sorted);
+    free(others);
+    free(seen);
+}
+
+// All local storage is placed at the top of the function's entry block, in
+// declaration order, so loops keep a constant stack size and mem2reg/SROA
+// can promote the slots.
+static LLVMValueRef build_entry_alloca(CodeGen *codegen, LLVMBuilderRef builder, LLVMTypeRef type, const char *name)
+{
+    LLVMBasicBlockRef entry = LLVMGetEntryBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)));
+    LLVMValueRef next = codegen->last_alloca ? LLVMGetNextInstruction(codegen->last_alloca)
+                                             : LLVMGetFirstInstruction(entry);
+    if (next)
+        LLVMPositionBuilderBefore(codegen->alloca_builder, next);
+    else
+        LLVMPositionBuilderAtEnd(codegen->alloca_builder, entry);
+
+    codegen->last_alloca = LLVMBuildAlloca(codegen->alloca_builder, type, name);
+    return codegen->last_alloca;
+}
+
+// Direct SSA construction. Scalars whose address is never taken are kept in
+// registers: their symbol holds the current definition, and the join points
+// of if/while/for get phi nodes for the variables assigned inside them.
+
+typedef struct
+{
+    char **names;
+    int count;
+    int capacity;
+} NameList;
+
+static void append_name(NameList *list, char *name)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->names = realloc(list->names, sizeof(char *) * list->capacity);
+        if (!list->names)
         {
-            error_report(-1, "Invalid array type '%s'.\n", type_name);
-            free(element_type_str);
+            error_report(-1, "Memory allocation failed in append_name.\n");
             exit(EXIT_FAILURE);
         }
-        *end_bracket = '\0';
+    }
+    list->names[list->count++] = name;
+}
+
+// Collects the names assigned to and the names whose address is taken
+// anywhere under `node`. Either list may be NULL.
+static void collect_names(Node *node, NameList *assigned, NameList *address_taken)
+{
+    if (!node)
+        return;
+
+    switch (node->type)
+    {
+    case AST_ASSIGNMENT:
+        if (assigned)
+            append_name(assigned, node->as.assignment.name);
+        collect_names(node->as.assignment.value, assigned, address_taken);
+        break;
+    case AST_ADDRESS_OF:
+        if (address_taken && node->as.operand->type == AST_IDENTIFIER)
+            append_name(address_taken, node->as.operand->as.name);
+        collect_names(node->as.operand, assigned, address_taken);
+        break;
+    case AST_PLUS:
+    case AST_MINUS:
+    case AST_STAR:
+    case AST_SLASH:
+    case AST_SHIFT_LEFT:
+    case AST_EQUAL_EQUAL:
+    case AST_BANG_EQUAL:
+    case AST_LESS:
+    case AST_LESS_EQUAL:
+    case AST_GREATER:
+    case AST_GREATER_EQUAL:
+        collect_names(node->as.binary.left, assigned, address_taken);
+        collect_names(node->as.binary.right, assigned, address_taken);
+        break;
+    case AST_NEGATE:
+    case AST_DEREFERENCE:
+    case AST_PRINT:
+    case AST_RETURN_STMT:
+    case AST_BLOCK:
+        collect_names(node->as.operand, assigned, address_taken);
+        break;
+    case AST_DEREFERENCE_ASSIGNMENT:
+        collect_names(node->as.dereference_assignment.target, assigned, address_taken);
+        collect_names(node->as.dereference_assignment.value, assigned, address_taken);
+        break;
+    case AST_VARIABLE_DECL:
+        collect_names(node->as.variable_decl.initializer, assigned, address_taken);
+        break;
+    case AST_ARRAY_DECL:
+        for (int i = 0; i < node->as.array_decl.element_count; ++i)
+            collect_names(node->as.array_decl.elements[i], assigned, address_taken);
+        break;
+    case AST_ARRAY_ACCESS:
+        collect_names(node->as.array_access.index, assigned, address_taken);
+        break;
+    case AST_ARRAY_ASSIGNMENT:
+        collect_names(node->as.array_assignment.index, assigned, address_taken);
+        collect_names(node->as.array_assignment.value, assigned, address_taken);
+        break;
+    case AST_FUNCTION_CALL:
+        for (int i = 0; i < node->as.function_call.arg_count; ++i)
+            collect_names(node->as.function_call.arguments[i], assigned, address_taken);
+        break;
+    case AST_STATEMENT_LIST:
+        for (Node *entry = node; entry != NULL; entry = entry->as.statement_list.next)
+            collect_names(entry->as.statement_list.statement, assigned, address_taken);
+        break;
+    case AST_CAST:
+        collect_names(node->as.cast.expression, assigned, address_taken);
+        break;
+    case AST_IF_STATEMENT:
+        collect_names(node->as.if_statement.condition, assigned, address_taken);
+        collect_names(node->as.if_statement.then_branch, assigned, address_taken);
+        collect_names(node->as.if_statement.else_branch, assigned, address_taken);
+        break;
+    case AST_WHILE_STATEMENT:
+        collect_names(node->as.while_statement.condition, assigned, address_taken);
+        collect_names(node->as.while_statement.body, assigned, address_taken);
+        break;
+    case AST_FOR_STATEMENT:
+        collect_names(node->as.for_statement.init, assigned, address_taken);
+        collect_names(node->as.for_statement.condition, assigned, address_taken);
+        collect_names(node->as.for_statement.increment, assigned, address_taken);
+        collect_names(node->as.for_statement.body, assigned, address_taken);
+        break;
+    default:
+        break;
+    }
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    char *left = *(char *const *)a;
+    char *right = *(char *const *)b;
+    return left < right ? -1 : left > right;
+}
+
+// Sorts the list by address and drops repeats, once per function, so each
+// local's lookup is a binary search. Names are interned, so equal names
+// are equal pointers.
+static void sort_distinct_names(NameList *list)
+{
+    qsort(list->names, list->count, sizeof(char *), compare_names);
+    int distinct = 0;
+    for (int i = 0; i < list->count; ++i)
+    {
+        if (distinct == 0 || list->names[distinct - 1] != list->names[i])
+            list->names[distinct++] = list->names[i];
+    }
+    list->count = distinct;
+}
+
+static int is_address_taken(CodeGen *codegen, char *name)
+{
+    return bsearch(&name, codegen->address_taken, codegen->address_taken_count, sizeof(char *), compare_names) != NULL;
+}
+
+static int compare_indices(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+// Returns the sorted, distinct indices of the visible SSA symbols that the
+// given subtrees assign to.
+static int *assigned_ssa_symbols(CodeGen *codegen, SymbolTable *sym_table, Node **roots, int root_count, int *count)
+{
+    *count = 0;
+    if (!codegen->direct_ssa)
+        return NULL;
+
+    NameList assigned = {NULL, 0, 0};
+    for (int i = 0; i < root_count; ++i)
+        collect_names(roots[i], &assigned, NULL);
+    if (assigned.count == 0)
+        return NULL;
+
+    int *indices = malloc(sizeof(int) * assigned.count);
+    if (!indices)
+    {
+        error_report(-1, "Memory allocation failed in assigned_ssa_symbols.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int found = 0;
+    for (int i = 0; i < assigned.count; ++i)
+    {
+        int index = find_symbol(sym_table, assigned.names[i]);
+        if (index >= 0 && sym_table->symbols[index].is_ssa)
+            indices[found++] = index;
+    }
+    free(assigned.names);
+
+    qsort(indices, found, sizeof(int), compare_indices);
+    int distinct = 0;
+    for (int i = 0; i < found; ++i)
+    {
+        if (distinct == 0 || indices[distinct - 1] != indices[i])
+            indices[distinct++] = indices[i];
+    }
+
+    *count = distinct;
+    return indices;
+}
+
+static LLVMValueRef *snapshot_values(SymbolTable *sym_table, int *indices, int count)
+{
+    LLVMValueRef *values = malloc(sizeof(LLVMValueRef) * (count ? count : 1));
+    if (!values)
+    {
+        error_report(-1, "Memory allocation failed in snapshot_values.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; ++i)
+        values[i] = sym_table->symbols[indices[i]].value;
+    return values;
+}
 
-        int size = atoi(size_str);
-        if (size <= 0)
+static void restore_values(SymbolTable *sym_table, int *indices, int count, LLVMValueRef *values)
+{
+    for (int i = 0; i < count; ++i)
+        sym_table->symbols[indices[i]].value = values[i];
+}
+
+// Sets each variable to its value at the start of the merge block the
+// builder is positioned in, given the values flowing in from the two
+// predecessors. Edges from terminated branches are NULL blocks.
+static void merge_values(SymbolTable *sym_table, int *indices, int count, LLVMBuilderRef builder,
+                         LLVMValueRef *values_a, LLVMBasicBlockRef block_a,
+                         LLVMValueRef *values_b, LLVMBasicBlockRef block_b)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Symbol *symbol = &sym_table->symbols[indices[i]];
+        if (!block_b || (block_a && values_a[i] == values_b[i]))
         {
-            error_report(-1, "Invalid array size in type '%s'.\n", type_name);
-            free(element_type_str);
-            exit(EXIT_FAILURE);
+            if (block_a)
+                symbol->value = values_a[i];
+            continue;
+        }
+        if (!block_a)
+        {
+            symbol->value = values_b[i];
+            continue;
         }
-        LLVMTypeRef element_type = get_llvm_type(element_type_str);
-        free(element_type_str);
-        return LLVMArrayType(element_type, size);
+
+        LLVMValueRef phi = LLVMBuildPhi(builder, LLVMTypeOf(values_a[i]), symbol->name);
+        LLVMValueRef incoming_values[] = {values_a[i], values_b[i]};
+        LLVMBasicBlockRef incoming_blocks[] = {block_a, block_b};
+        LLVMAddIncoming(phi, incoming_values, incoming_blocks, 2);
+        symbol->value = phi;
     }
-    else if (strcmp(type_name, "i8") == 0)
-        return LLVMInt8Type();
-    else if (strcmp(type_name, "i16") == 0)
-        return LLVMInt16Type();
-    else if (strcmp(type_name, "i32") == 0)
-        return LLVMInt32Type();
-    else if (strcmp(type_name, "i64") == 0)
-        return LLVMInt64Type();
-    else if (strcmp(type_name, "void") == 0)
-        return LLVMVoidType();
-    else
+}
+
+// Creates a phi at the top of a loop header for every variable the loop
+// assigns, fed from the preheader. The back edges are added once the body
+// has been generated.
+static LLVMValueRef *begin_loop_phis(SymbolTable *sym_table, int *indices, int count, LLVMBuilderRef builder,
+                                     LLVMBasicBlockRef preheader)
+{
+    LLVMValueRef *phis = snapshot_values(sym_table, indices, count);
+    for (int i = 0; i < count; ++i)
+    {
+        Symbol *symbol = &sym_table->symbols[indices[i]];
+        LLVMValueRef entry_value = symbol->value;
+        LLVMValueRef phi = LLVMBuildPhi(builder, LLVMTypeOf(entry_value), symbol->name);
+        LLVMAddIncoming(phi, &entry_value, &preheader, 1);
+        symbol->value = phi;
+        phis[i] = phi;
+    }
+    return phis;
+}
+
+static void add_loop_back_edge(SymbolTable *sym_table, int *indices, int count, LLVMValueRef *phis,
+                               LLVMBasicBlockRef latch)
+{
+    for (int i = 0; i < count; ++i)
     {
-        error_report(-1, "Unsupported type '%s'.\n", type_name);
+        LLVMValueRef value = sym_table->symbols[indices[i]].value;
+        LLVMAddIncoming(phis[i], &value, &latch, 1);
+    }
+}
+
+// The loop exits from its header, so each variable leaves with its phi.
+// Phis whose incoming values are all the same value (or the phi itself)
+// are replaced by that value.
+static void finish_loop_phis(SymbolTable *sym_table, int *indices, int count, LLVMValueRef *phis)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        LLVMValueRef phi = phis[i];
+        LLVMValueRef same = NULL;
+        int trivial = 1;
+        for (unsigned int j = 0; j < LLVMCountIncoming(phi); ++j)
+        {
+            LLVMValueRef incoming = LLVMGetIncomingValue(phi, j);
+            if (incoming == phi || incoming == same)
+                continue;
+            if (same)
+            {
+                trivial = 0;
+                break;
+            }
+            same = incoming;
+        }
+
+        sym_table->symbols[indices[i]].value = phi;
+        if (!trivial || !same)
+            continue;
+
+        LLVMReplaceAllUsesWith(phi, same);
+        LLVMInstructionEraseFromParent(phi);
+        sym_table->symbols[indices[i]].value = same;
+    }
+}
+
+static int lookup_array(SymbolTable *sym_table, char *name)
+{
+    int index = find_symbol(sym_table, name);
+    if (index < 0)
+    {
+        error_report(-1, "Undefined array '%s'.\n", name);
         exit(EXIT_FAILURE);
     }
+    if (sym_table->symbols[index].is_ssa)
+    {
+        error_report(-1, "'%s' is not an array.\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return index;
 }
 
-LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf_func, LLVMValueRef format_str, SymbolTable *sym_table, LLVMBuilderRef builder)
+LLVMValueRef generate_code(Node *node, CodeGen *codegen, SymbolTable *sym_table, LLVMBuilderRef builder)
 {
     if (!node)
     {
@@ -99,16 +616,30 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        char *var_name = node->var_name;
-        LLVMValueRef var = get_symbol(sym_table, var_name);
-        if (!var)
+        char *var_name = node->as.assignment.name;
+        int index = find_symbol(sym_table, var_name);
+        if (index < 0)
         {
             error_report(-1, "Undefined variable '%s' in assignment.\n", var_name);
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
-        LLVMBuildStore(builder, expr, var);
+        LLVMValueRef expr = generate_code(node->as.assignment.value, codegen, sym_table, builder);
+
+        Symbol *symbol = &sym_table->symbols[index];
+        if (symbol->is_ssa)
+        {
+            if (LLVMTypeOf(expr) != LLVMTypeOf(symbol->value))
+            {
+                error_report(-1, "Type mismatch in assignment to '%s'.\n", var_name);
+                exit(EXIT_FAILURE);
+            }
+            symbol->value = expr;
+        }
+        else
+        {
+            LLVMBuildStore(builder, expr, symbol->value);
+        }
 
         return expr;
     }
@@ -120,21 +651,26 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        if (node->expression->type != AST_IDENTIFIER)
+        if (node->as.operand->type != AST_IDENTIFIER)
         {
             fprintf(stderr, "Error: Can only take address of a variable.\n");
             exit(EXIT_FAILURE);
         }
 
-        char *var_name = node->expression->var_name;
-        LLVMValueRef var = get_symbol(sym_table, var_name);
-        if (!var)
+        char *var_name = node->as.operand->as.name;
+        int index = find_symbol(sym_table, var_name);
+        if (index < 0)
         {
             fprintf(stderr, "Error: Undefined variable '%s' in address-of operation.\n", var_name);
             exit(EXIT_FAILURE);
         }
+        if (sym_table->symbols[index].is_ssa)
+        {
+            fprintf(stderr, "Error: Variable '%s' has no stack slot.\n", var_name);
+            exit(EXIT_FAILURE);
+        }
 
-        return var;
+        return sym_table->symbols[index].value;
     }
     case AST_DEREFERENCE:
     {
@@ -144,7 +680,7 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef expr = generate_code(node->as.operand, codegen, sym_table, builder);
         LLVMTypeRef expr_type = LLVMTypeOf(expr);
 
         if (LLVMGetTypeKind(expr_type) != LLVMPointerTypeKind)
@@ -158,45 +694,35 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
 
         return loaded;
     }
-    case AST_ARRAY_TYPE:
-    {
-        LLVMTypeRef element_type = get_llvm_type(node->var_type);
-        LLVMTypeRef array_type = LLVMArrayType(element_type, node->number_value);
-        return array_type;
-    }
     case AST_ARRAY_DECL:
     {
-        LLVMTypeRef element_type = get_llvm_type(node->var_type);
-        LLVMTypeRef array_type = LLVMArrayType(element_type, node->number_value);
-        LLVMValueRef alloca = LLVMBuildAlloca(builder, array_type, node->var_name);
-        add_symbol(sym_table, node->var_name, alloca);
-        for (int i = 0; i < node->param_count; ++i)
-        {
-            LLVMValueRef index = LLVMConstInt(LLVMInt32Type(), i, 0);
-            LLVMValueRef indices[] = {LLVMConstInt(LLVMInt32Type(), 0, 0), index};
+        LLVMTypeRef element_type = get_llvm_type(codegen, node->as.array_decl.element_type);
+        LLVMTypeRef array_type = LLVMArrayType(element_type, node->as.array_decl.length);
+        LLVMValueRef alloca = build_entry_alloca(codegen, builder, array_type, node->as.array_decl.name);
+        add_symbol(sym_table, node->as.array_decl.name, alloca, 0);
+        for (int i = 0; i < node->as.array_decl.element_count; ++i)
+        {
+            LLVMValueRef index = LLVMConstInt(LLVMInt32TypeInContext(codegen->context), i, 0);
+            LLVMValueRef indices[] = {LLVMConstInt(LLVMInt32TypeInContext(codegen->context), 0, 0), index};
             LLVMValueRef element_ptr = LLVMBuildGEP2(builder, array_type, alloca, indices, 2, "arrayelem");
-            LLVMValueRef element_value = generate_code(node->parameters[i], module, printf_func, format_str, sym_table, builder);
+            LLVMValueRef element_value = generate_code(node->as.array_decl.elements[i], codegen, sym_table, builder);
             LLVMBuildStore(builder, element_value, element_ptr);
         }
         return alloca;
     }
     case AST_ARRAY_ASSIGNMENT:
     {
-        LLVMValueRef array_ptr = get_symbol(sym_table, node->var_name);
-        if (!array_ptr)
-        {
-            error_report(-1, "Undefined array '%s'.\n", node->var_name);
-            exit(EXIT_FAILURE);
-        }
+        int array_index = lookup_array(sym_table, node->as.array_assignment.name);
 
-        LLVMValueRef index = generate_code(node->left, module, printf_func, format_str, sym_table, builder);
-        LLVMValueRef value = generate_code(node->right, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef index = generate_code(node->as.array_assignment.index, codegen, sym_table, builder);
+        LLVMValueRef value = generate_code(node->as.array_assignment.value, codegen, sym_table, builder);
+        LLVMValueRef array_ptr = sym_table->symbols[array_index].value;
 
         LLVMTypeRef array_ptr_type = LLVMTypeOf(array_ptr);
         LLVMTypeRef array_type = LLVMGetElementType(array_ptr_type);
         LLVMTypeRef element_type = LLVMGetElementType(array_type);
 
-        LLVMValueRef zero = LLVMConstInt(LLVMInt32Type(), 0, 0);
+        LLVMValueRef zero = LLVMConstInt(LLVMInt32TypeInContext(codegen->context), 0, 0);
         LLVMValueRef indices[] = {zero, index};
 
         LLVMValueRef element_ptr = LLVMBuildGEP2(builder, array_type, array_ptr, indices, 2, "arrayelem");
@@ -206,13 +732,9 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
     }
     case AST_ARRAY_ACCESS:
     {
-        LLVMValueRef array_ptr = get_symbol(sym_table, node->var_name);
-        if (!array_ptr)
-        {
-            fprintf(stderr, "Error: Undefined array '%s'.\n", node->var_name);
-            exit(EXIT_FAILURE);
-        }
-        LLVMValueRef index = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
+        int array_index = lookup_array(sym_table, node->as.array_access.name);
+        LLVMValueRef index = generate_code(node->as.array_access.index, codegen, sym_table, builder);
+        LLVMValueRef array_ptr = sym_table->symbols[array_index].value;
 
         LLVMTypeRef array_ptr_type = LLVMTypeOf(array_ptr);
 
@@ -220,7 +742,7 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
 
         LLVMTypeRef element_type = LLVMGetElementType(array_type);
 
-        LLVMValueRef zero = LLVMConstInt(LLVMInt32Type(), 0, 0);
+        LLVMValueRef zero = LLVMConstInt(LLVMInt32TypeInContext(codegen->context), 0, 0);
         LLVMValueRef indices[] = {zero, index};
 
         LLVMValueRef element_ptr = LLVMBuildGEP2(builder, array_type, array_ptr, indices, 2, "arrayelem");
@@ -237,7 +759,7 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef expr = generate_code(node->left, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef expr = generate_code(node->as.operand, codegen, sym_table, builder);
         if (!expr)
         {
             fprintf(stderr, "Error: Failed to generate expression for negate.\n");
@@ -259,42 +781,53 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
 
     case AST_FUNCTION_DECL:
     {
-        LLVMTypeRef return_type = LLVMVoidType();
-        if (node->return_type)
-        {
-            return_type = get_llvm_type(node->return_type);
-        }
+        LLVMValueRef func = declare_function(codegen, node);
+        if (node->as.function_decl.is_prototype)
+            return func;
 
-        LLVMTypeRef *param_types = malloc(sizeof(LLVMTypeRef) * node->param_count);
-        for (int i = 0; i < node->param_count; ++i)
+        if (LLVMCountBasicBlocks(func) > 0)
         {
-            param_types[i] = get_llvm_type(node->parameters[i]->var_type);
+            error_report(-1, "Function '%s' is already defined.\n", node->as.function_decl.name);
+            exit(EXIT_FAILURE);
         }
 
-        LLVMTypeRef func_type = LLVMFunctionType(return_type, param_types, node->param_count, 0);
-        LLVMValueRef func = LLVMAddFunction(module, node->func_name, func_type);
+        LLVMTypeRef return_type = LLVMGetReturnType(LLVMGetElementType(LLVMTypeOf(func)));
 
-        LLVMBasicBlockRef func_entry = LLVMAppendBasicBlock(func, "entry");
-        LLVMBuilderRef func_builder = LLVMCreateBuilder();
+        LLVMBasicBlockRef func_entry = LLVMAppendBasicBlockInContext(codegen->context, func, "entry");
+        LLVMBuilderRef func_builder = LLVMCreateBuilderInContext(codegen->context);
         LLVMPositionBuilderAtEnd(func_builder, func_entry);
+        codegen->last_alloca = NULL;
 
-        SymbolTable *func_sym_table = create_symbol_table();
+        push_scope(sym_table);
 
-        for (int i = 0; i < node->param_count; ++i)
+        NameList address_taken = {NULL, 0, 0};
+        if (codegen->direct_ssa)
+            collect_names(node->as.function_decl.body, NULL, &address_taken);
+        sort_distinct_names(&address_taken);
+        codegen->address_taken = address_taken.names;
+        codegen->address_taken_count = address_taken.count;
+
+        for (int i = 0; i < node->as.function_decl.param_count; ++i)
         {
             LLVMValueRef param = LLVMGetParam(func, i);
-            char *param_name = node->parameters[i]->var_name;
-            LLVMTypeRef param_type = param_types[i];
-            LLVMValueRef alloca = LLVMBuildAlloca(func_builder, param_type, param_name);
+            char *param_name = node->as.function_decl.parameters[i]->as.variable_decl.name;
+            LLVMTypeRef param_type = LLVMTypeOf(param);
+            if (codegen->direct_ssa && !is_address_taken(codegen, param_name))
+            {
+                LLVMSetValueName2(param, param_name, strlen(param_name));
+                add_symbol(sym_table, param_name, param, 1);
+                continue;
+            }
+            LLVMValueRef alloca = build_entry_alloca(codegen, func_builder, param_type, param_name);
             LLVMBuildStore(func_builder, param, alloca);
-            add_symbol(func_sym_table, param_name, alloca);
+            add_symbol(sym_table, param_name, alloca, 0);
         }
 
-        generate_code(node->body, module, printf_func, format_str, func_sym_table, func_builder);
+        generate_code(node->as.function_decl.body, codegen, sym_table, func_builder);
 
         if (LLVMGetBasicBlockTerminator(LLVMGetInsertBlock(func_builder)) == NULL)
         {
-            if (LLVMGetReturnType(func_type) == LLVMVoidType())
+            if (LLVMGetTypeKind(return_type) == LLVMVoidTypeKind)
             {
                 LLVMBuildRetVoid(func_builder);
             }
@@ -305,8 +838,10 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
         }
 
         LLVMDisposeBuilder(func_builder);
-        free_symbol_table(func_sym_table);
-        free(param_types);
+        pop_scope(sym_table);
+        free(address_taken.names);
+        codegen->address_taken = NULL;
+        codegen->address_taken_count = 0;
 
         return func;
     }
@@ -319,14 +854,23 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
         }
 
         LLVMValueRef expr = NULL;
-        if (node->expression)
+        if (node->as.operand)
         {
-            expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
+            expr = generate_code(node->as.operand, codegen, sym_table, builder);
             LLVMBuildRet(builder, expr);
         }
         else
         {
-            LLVMBuildRetVoid(builder);
+            LLVMValueRef func = LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder));
+            LLVMTypeRef return_type = LLVMGetReturnType(LLVMGetElementType(LLVMTypeOf(func)));
+            if (LLVMGetTypeKind(return_type) == LLVMVoidTypeKind)
+            {
+                LLVMBuildRetVoid(builder);
+            }
+            else
+            {
+                LLVMBuildRet(builder, LLVMConstNull(return_type));
+            }
         }
         return expr;
     }
@@ -335,8 +879,27 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
         Node *current = node;
         while (current != NULL)
         {
-            generate_code(current->left, module, printf_func, format_str, sym_table, builder);
-            current = current->right;
+            generate_code(current->as.statement_list.statement, codegen, sym_table, builder);
+            current = current->as.statement_list.next;
+        }
+        break;
+    }
+    case AST_BLOCK:
+    {
+        if (!node->as.operand)
+            break;
+
+        push_scope(sym_table);
+        generate_code(node->as.operand, codegen, sym_table, builder);
+        pop_scope(sym_table);
+
+        // A block lifted out of a pruned if may end in a return; code after it
+        // goes into an unreachable block, as it would after the if's merge block.
+        LLVMBasicBlockRef current_block = LLVMGetInsertBlock(builder);
+        if (LLVMGetBasicBlockTerminator(current_block) != NULL)
+        {
+            LLVMBasicBlockRef cont_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(current_block), "blockcont");
+            LLVMPositionBuilderAtEnd(builder, cont_block);
         }
         break;
     }
@@ -348,16 +911,17 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef condition = generate_code(node->condition, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef condition = generate_code(node->as.if_statement.condition, codegen, sym_table, builder);
 
         LLVMValueRef zero = LLVMConstInt(LLVMTypeOf(condition), 0, 0);
         LLVMValueRef cond = LLVMBuildICmp(builder, LLVMIntNE, condition, zero, "ifcond");
 
-        LLVMBasicBlockRef then_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "then");
-        LLVMBasicBlockRef else_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "else");
-        LLVMBasicBlockRef merge_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "ifcont");
+        LLVMBasicBlockRef cond_block = LLVMGetInsertBlock(builder);
+        LLVMBasicBlockRef then_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(cond_block), "then");
+        LLVMBasicBlockRef else_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(cond_block), "else");
+        LLVMBasicBlockRef merge_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(cond_block), "ifcont");
 
-        if (node->else_branch)
+        if (node->as.if_statement.else_branch)
         {
             LLVMBuildCondBr(builder, cond, then_block, else_block);
         }
@@ -366,17 +930,37 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             LLVMBuildCondBr(builder, cond, then_block, merge_block);
         }
 
+        Node *branches[] = {node->as.if_statement.then_branch, node->as.if_statement.else_branch};
+        int ssa_count;
+        int *ssa_vars = assigned_ssa_symbols(codegen, sym_table, branches, 2, &ssa_count);
+        LLVMValueRef *entry_values = snapshot_values(sym_table, ssa_vars, ssa_count);
+
         LLVMPositionBuilderAtEnd(builder, then_block);
-        generate_code(node->then_branch, module, printf_func, format_str, sym_table, builder);
-        if (LLVMGetBasicBlockTerminator(LLVMGetInsertBlock(builder)) == NULL)
+        push_scope(sym_table);
+        generate_code(node->as.if_statement.then_branch, codegen, sym_table, builder);
+        pop_scope(sym_table);
+        LLVMBasicBlockRef then_end = LLVMGetInsertBlock(builder);
+        LLVMValueRef *then_values = snapshot_values(sym_table, ssa_vars, ssa_count);
+        if (LLVMGetBasicBlockTerminator(then_end) == NULL)
             LLVMBuildBr(builder, merge_block);
+        else
+            then_end = NULL;
 
-        if (node->else_branch)
+        restore_values(sym_table, ssa_vars, ssa_count, entry_values);
+        LLVMBasicBlockRef else_end = cond_block;
+        LLVMValueRef *else_values = entry_values;
+        if (node->as.if_statement.else_branch)
         {
             LLVMPositionBuilderAtEnd(builder, else_block);
-            generate_code(node->else_branch, module, printf_func, format_str, sym_table, builder);
-            if (LLVMGetBasicBlockTerminator(LLVMGetInsertBlock(builder)) == NULL)
+            push_scope(sym_table);
+            generate_code(node->as.if_statement.else_branch, codegen, sym_table, builder);
+            pop_scope(sym_table);
+            else_end = LLVMGetInsertBlock(builder);
+            else_values = snapshot_values(sym_table, ssa_vars, ssa_count);
+            if (LLVMGetBasicBlockTerminator(else_end) == NULL)
                 LLVMBuildBr(builder, merge_block);
+            else
+                else_end = NULL;
         }
         else
         {
@@ -384,6 +968,13 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
         }
 
         LLVMPositionBuilderAtEnd(builder, merge_block);
+        merge_values(sym_table, ssa_vars, ssa_count, builder, then_values, then_end, else_values, else_end);
+
+        if (else_values != entry_values)
+            free(else_values);
+        free(then_values);
+        free(entry_values);
+        free(ssa_vars);
 
         break;
     }
@@ -395,24 +986,45 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef expr = generate_code(node->as.operand, codegen, sym_table, builder);
         if (!expr)
         {
             fprintf(stderr, "Error: Failed to generate expression for print.\n");
             exit(EXIT_FAILURE);
         }
 
+        // Each integer width has its own print routine; i64 values used to go
+        // through "%d" and were truncated.
         LLVMTypeRef expr_type = LLVMTypeOf(expr);
-        LLVMValueRef format_str_ptr;
-
+        const char *routine;
         if (LLVMGetTypeKind(expr_type) == LLVMIntegerTypeKind)
         {
-            format_str_ptr = LLVMBuildBitCast(builder, format_str, LLVMPointerType(LLVMInt8Type(), 0), "fmt_ptr");
+            switch (LLVMGetIntTypeWidth(expr_type))
+            {
+            case 8:
+                routine = "syro_print_i8";
+                break;
+            case 16:
+                routine = "syro_print_i16";
+                break;
+            case 32:
+                routine = "syro_print_i32";
+                break;
+            case 64:
+                routine = "syro_print_i64";
+                break;
+            default:
+                expr_type = LLVMInt64TypeInContext(codegen->context);
+                expr = LLVMBuildSExt(builder, expr, expr_type, "printext");
+                routine = "syro_print_i64";
+                break;
+            }
         }
         else if (LLVMGetTypeKind(expr_type) == LLVMPointerTypeKind)
         {
-            LLVMValueRef ptr_format_str = LLVMBuildGlobalStringPtr(builder, "%p\n", "ptrfmt");
-            format_str_ptr = LLVMBuildBitCast(builder, ptr_format_str, LLVMPointerType(LLVMInt8Type(), 0), "fmt_ptr");
+            expr_type = LLVMPointerType(LLVMInt8TypeInContext(codegen->context), 0);
+            expr = LLVMBuildBitCast(builder, expr, expr_type, "printptr");
+            routine = "syro_print_ptr";
         }
         else
         {
@@ -420,23 +1032,8 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef args[] = {format_str_ptr, expr};
-
-        LLVMTypeRef printf_func_type = LLVMGetElementType(LLVMTypeOf(printf_func));
-        LLVMValueRef printf_call = LLVMBuildCall2(
-            builder,
-            printf_func_type,
-            printf_func,
-            args,
-            2,
-            "callprintf");
-        if (!printf_call)
-        {
-            fprintf(stderr, "Error: Failed to build call to printf.\n");
-            exit(EXIT_FAILURE);
-        }
-
-        return printf_call;
+        LLVMValueRef print_func = get_runtime_function(codegen, routine, expr_type);
+        return LLVMBuildCall2(builder, LLVMGlobalGetValueType(print_func), print_func, &expr, 1, "");
     }
     case AST_DEREFERENCE_ASSIGNMENT:
     {
@@ -446,14 +1043,14 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef ptr = generate_code(node->left, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef ptr = generate_code(node->as.dereference_assignment.target, codegen, sym_table, builder);
         if (LLVMGetTypeKind(LLVMTypeOf(ptr)) != LLVMPointerTypeKind)
         {
             fprintf(stderr, "Error: Left side of dereference assignment is not a pointer.\n");
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef value = generate_code(node->right, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef value = generate_code(node->as.dereference_assignment.value, codegen, sym_table, builder);
         LLVMBuildStore(builder, value, ptr);
         return value;
     }
@@ -466,27 +1063,43 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMTypeRef var_type = get_llvm_type(node->var_type);
-        if (var_type == LLVMVoidType())
+        if (node->as.variable_decl.type->kind == TYPE_VOID)
         {
             fprintf(stderr, "Error: Cannot declare variable of type 'void'.\n");
             exit(EXIT_FAILURE);
         }
+        LLVMTypeRef var_type = get_llvm_type(codegen, node->as.variable_decl.type);
 
-        char *var_name = node->var_name;
+        char *var_name = node->as.variable_decl.name;
 
-        LLVMValueRef alloca = LLVMBuildAlloca(builder, var_type, var_name);
+        if (codegen->direct_ssa && !is_address_taken(codegen, var_name))
+        {
+            LLVMValueRef value = LLVMConstNull(var_type);
+            if (node->as.variable_decl.initializer)
+            {
+                value = generate_code(node->as.variable_decl.initializer, codegen, sym_table, builder);
+                if (LLVMTypeOf(value) != var_type)
+                {
+                    error_report(-1, "Type mismatch in initialization of '%s'.\n", var_name);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            add_symbol(sym_table, var_name, value, 1);
+            return value;
+        }
+
+        LLVMValueRef alloca = build_entry_alloca(codegen, builder, var_type, var_name);
         if (!alloca)
         {
             fprintf(stderr, "Error: Failed to allocate memory for variable '%s'.\n", var_name);
             exit(EXIT_FAILURE);
         }
 
-        add_symbol(sym_table, var_name, alloca);
+        add_symbol(sym_table, var_name, alloca, 0);
 
-        if (node->expression)
+        if (node->as.variable_decl.initializer)
         {
-            LLVMValueRef expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
+            LLVMValueRef expr = generate_code(node->as.variable_decl.initializer, codegen, sym_table, builder);
             if (!expr)
             {
                 fprintf(stderr, "Error: Failed to generate expression for variable '%s'.\n", var_name);
@@ -510,13 +1123,17 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        char *var_name = node->var_name;
-        LLVMValueRef var = get_symbol(sym_table, var_name);
-        if (!var)
+        char *var_name = node->as.name;
+        int index = find_symbol(sym_table, var_name);
+        if (index < 0)
         {
             fprintf(stderr, "Error: Undefined variable '%s'.\n", var_name);
             exit(EXIT_FAILURE);
         }
+        if (sym_table->symbols[index].is_ssa)
+            return sym_table->symbols[index].value;
+
+        LLVMValueRef var = sym_table->symbols[index].value;
 
         LLVMTypeRef var_ptr_type = LLVMTypeOf(var);
         LLVMTypeRef var_type = LLVMGetElementType(var_ptr_type);
@@ -531,7 +1148,7 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
         return loaded;
     }
     case AST_NUMBER:
-        return LLVMConstInt(LLVMInt32Type(), node->number_value, 0);
+        return LLVMConstInt(LLVMInt32TypeInContext(codegen->context), node->as.number, 0);
     case AST_EQUAL_EQUAL:
     case AST_BANG_EQUAL:
     case AST_LESS:
@@ -539,8 +1156,8 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
     case AST_GREATER:
     case AST_GREATER_EQUAL:
     {
-        LLVMValueRef left = generate_code(node->left, module, printf_func, format_str, sym_table, builder);
-        LLVMValueRef right = generate_code(node->right, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef left = generate_code(node->as.binary.left, codegen, sym_table, builder);
+        LLVMValueRef right = generate_code(node->as.binary.right, codegen, sym_table, builder);
 
         LLVMValueRef cmp_result;
 
@@ -569,12 +1186,13 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        return LLVMBuildZExt(builder, cmp_result, LLVMInt32Type(), "booltmp");
+        return LLVMBuildZExt(builder, cmp_result, LLVMInt32TypeInContext(codegen->context), "booltmp");
     }
     case AST_PLUS:
     case AST_MINUS:
     case AST_STAR:
     case AST_SLASH:
+    case AST_SHIFT_LEFT:
     {
         if (!builder)
         {
@@ -582,8 +1200,8 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef left = generate_code(node->left, module, printf_func, format_str, sym_table, builder);
-        LLVMValueRef right = generate_code(node->right, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef left = generate_code(node->as.binary.left, codegen, sym_table, builder);
+        LLVMValueRef right = generate_code(node->as.binary.right, codegen, sym_table, builder);
         if (!left || !right)
         {
             fprintf(stderr, "Error: Failed to generate operands for binary operation.\n");
@@ -611,6 +1229,8 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
                 return LLVMBuildMul(builder, left, right, "multmp");
             case AST_SLASH:
                 return LLVMBuildSDiv(builder, left, right, "divtmp");
+            case AST_SHIFT_LEFT:
+                return LLVMBuildShl(builder, left, right, "shltmp");
             default:
                 fprintf(stderr, "Error: Unsupported binary operation.\n");
                 exit(EXIT_FAILURE);
@@ -630,30 +1250,30 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef function = LLVMGetNamedFunction(module, node->func_name);
+        LLVMValueRef function = LLVMGetNamedFunction(codegen->module, node->as.function_call.name);
         if (!function)
         {
-            fprintf(stderr, "Error: Function '%s' not found.\n", node->func_name);
+            fprintf(stderr, "Error: Function '%s' not found.\n", node->as.function_call.name);
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef *args = malloc(sizeof(LLVMValueRef) * node->param_count);
-        for (int i = 0; i < node->param_count; ++i)
+        LLVMValueRef *args = malloc(sizeof(LLVMValueRef) * node->as.function_call.arg_count);
+        for (int i = 0; i < node->as.function_call.arg_count; ++i)
         {
-            args[i] = generate_code(node->parameters[i], module, printf_func, format_str, sym_table, builder);
+            args[i] = generate_code(node->as.function_call.arguments[i], codegen, sym_table, builder);
             if (!args[i])
             {
-                fprintf(stderr, "Error: Failed to generate code for argument %d in function call '%s'.\n", i, node->func_name);
+                fprintf(stderr, "Error: Failed to generate code for argument %d in function call '%s'.\n", i, node->as.function_call.name);
                 exit(EXIT_FAILURE);
             }
         }
 
         LLVMTypeRef function_type = LLVMGetElementType(LLVMTypeOf(function));
 
-        LLVMValueRef call = LLVMBuildCall2(builder, function_type, function, args, node->param_count, "");
+        LLVMValueRef call = LLVMBuildCall2(builder, function_type, function, args, node->as.function_call.arg_count, "");
         if (!call)
         {
-            fprintf(stderr, "Error: Failed to build function call '%s'.\n", node->func_name);
+            fprintf(stderr, "Error: Failed to build function call '%s'.\n", node->as.function_call.name);
             exit(EXIT_FAILURE);
         }
 
@@ -668,8 +1288,8 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMValueRef expr = generate_code(node->expression, module, printf_func, format_str, sym_table, builder);
-        LLVMTypeRef target_type = get_llvm_type(node->cast_type);
+        LLVMValueRef expr = generate_code(node->as.cast.expression, codegen, sym_table, builder);
+        LLVMTypeRef target_type = get_llvm_type(codegen, node->as.cast.type);
 
         LLVMTypeRef expr_type = LLVMTypeOf(expr);
 
@@ -705,25 +1325,40 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMBasicBlockRef cond_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "whilecond");
-        LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "whilebody");
-        LLVMBasicBlockRef end_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "whileend");
+        LLVMBasicBlockRef preheader = LLVMGetInsertBlock(builder);
+        LLVMBasicBlockRef cond_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(preheader), "whilecond");
+        LLVMBasicBlockRef body_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(preheader), "whilebody");
+        LLVMBasicBlockRef end_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(preheader), "whileend");
 
         LLVMBuildBr(builder, cond_block);
 
+        Node *loop_parts[] = {node->as.while_statement.condition, node->as.while_statement.body};
+        int ssa_count;
+        int *ssa_vars = assigned_ssa_symbols(codegen, sym_table, loop_parts, 2, &ssa_count);
+
         LLVMPositionBuilderAtEnd(builder, cond_block);
-        LLVMValueRef condition = generate_code(node->condition, module, printf_func, format_str, sym_table, builder);
+        LLVMValueRef *phis = begin_loop_phis(sym_table, ssa_vars, ssa_count, builder, preheader);
+        LLVMValueRef condition = generate_code(node->as.while_statement.condition, codegen, sym_table, builder);
         LLVMValueRef zero = LLVMConstInt(LLVMTypeOf(condition), 0, 0);
         LLVMValueRef cond = LLVMBuildICmp(builder, LLVMIntNE, condition, zero, "whilecond");
 
         LLVMBuildCondBr(builder, cond, body_block, end_block);
 
         LLVMPositionBuilderAtEnd(builder, body_block);
-        generate_code(node->body, module, printf_func, format_str, sym_table, builder);
-        LLVMBuildBr(builder, cond_block);
+        push_scope(sym_table);
+        generate_code(node->as.while_statement.body, codegen, sym_table, builder);
+        pop_scope(sym_table);
+        if (LLVMGetBasicBlockTerminator(LLVMGetInsertBlock(builder)) == NULL)
+        {
+            add_loop_back_edge(sym_table, ssa_vars, ssa_count, phis, LLVMGetInsertBlock(builder));
+            LLVMBuildBr(builder, cond_block);
+        }
+        finish_loop_phis(sym_table, ssa_vars, ssa_count, phis);
 
         LLVMPositionBuilderAtEnd(builder, end_block);
 
+        free(phis);
+        free(ssa_vars);
         break;
     }
     case AST_FOR_STATEMENT:
@@ -734,48 +1369,63 @@ LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf
             exit(EXIT_FAILURE);
         }
 
-        LLVMBasicBlockRef init_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forinit");
-        LLVMBasicBlockRef cond_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forcond");
-        LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forbody");
-        LLVMBasicBlockRef increment_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forinc");
-        LLVMBasicBlockRef end_block = LLVMAppendBasicBlock(LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forend");
+        LLVMBasicBlockRef init_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forinit");
+        LLVMBasicBlockRef cond_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forcond");
+        LLVMBasicBlockRef body_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forbody");
+        LLVMBasicBlockRef increment_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forinc");
+        LLVMBasicBlockRef end_block = LLVMAppendBasicBlockInContext(codegen->context, LLVMGetBasicBlockParent(LLVMGetInsertBlock(builder)), "forend");
 
         LLVMBuildBr(builder, init_block);
 
         LLVMPositionBuilderAtEnd(builder, init_block);
-        if (node->init)
+        if (node->as.for_statement.init)
         {
-            generate_code(node->init, module, printf_func, format_str, sym_table, builder);
+            generate_code(node->as.for_statement.init, codegen, sym_table, builder);
         }
+        LLVMBasicBlockRef preheader = LLVMGetInsertBlock(builder);
         LLVMBuildBr(builder, cond_block);
 
+        Node *loop_parts[] = {node->as.for_statement.condition, node->as.for_statement.body, node->as.for_statement.increment};
+        int ssa_count;
+        int *ssa_vars = assigned_ssa_symbols(codegen, sym_table, loop_parts, 3, &ssa_count);
+
         LLVMPositionBuilderAtEnd(builder, cond_block);
+        LLVMValueRef *phis = begin_loop_phis(sym_table, ssa_vars, ssa_count, builder, preheader);
         LLVMValueRef condition = NULL;
-        if (node->condition)
+        if (node->as.for_statement.condition)
         {
-            condition = generate_code(node->condition, module, printf_func, format_str, sym_table, builder);
+            condition = generate_code(node->as.for_statement.condition, codegen, sym_table, builder);
         }
         else
         {
-            condition = LLVMConstInt(LLVMInt1Type(), 1, 0);
+            condition = LLVMConstInt(LLVMInt1TypeInContext(codegen->context), 1, 0);
         }
         LLVMValueRef zero = LLVMConstInt(LLVMTypeOf(condition), 0, 0);
         LLVMValueRef cond_value = LLVMBuildICmp(builder, LLVMIntNE, condition, zero, "forcond");
         LLVMBuildCondBr(builder, cond_value, body_block, end_block);
 
         LLVMPositionBuilderAtEnd(builder, body_block);
-        generate_code(node->body, module, printf_func, format_str, sym_table, builder);
-        LLVMBuildBr(builder, increment_block);
+        push_scope(sym_table);
+        generate_code(node->as.for_statement.body, codegen, sym_table, builder);
+        pop_scope(sym_table);
+        if (LLVMGetBasicBlockTerminator(LLVMGetInsertBlock(builder)) == NULL)
+        {
+            LLVMBuildBr(builder, increment_block);
+        }
 
         LLVMPositionBuilderAtEnd(builder, increment_block);
-        if (node->increment)
+        if (node->as.for_statement.increment)
         {
-            generate_code(node->increment, module, printf_func, format_str, sym_table, builder);
+            generate_code(node->as.for_statement.increment, codegen, sym_table, builder);
         }
+        add_loop_back_edge(sym_table, ssa_vars, ssa_count, phis, LLVMGetInsertBlock(builder));
         LLVMBuildBr(builder, cond_block);
+        finish_loop_phis(sym_table, ssa_vars, ssa_count, phis);
 
         LLVMPositionBuilderAtEnd(builder, end_block);
 
+        free(phis);
+        free(ssa_vars);
         break;
     }
 
@@ -7,6 +7,24 @@
 #include <parser/ast.h>
 #include <symbol_table/symbol_table.h>
 
-LLVMValueRef generate_code(Node *node, LLVMModuleRef module, LLVMValueRef printf_func, LLVMValueRef format_str, SymbolTable *sym_table, LLVMBuilderRef builder);
+typedef struct
+{
+    LLVMContextRef context;
+    LLVMModuleRef module;
+    LLVMTypeRef *type_cache;
+    int type_cache_size;
+    int direct_ssa;
+    LLVMBuilderRef alloca_builder;
+    LLVMValueRef last_alloca;
+    char **address_taken;
+    int address_taken_count;
+} CodeGen;
+
+void init_codegen(CodeGen *codegen, LLVMModuleRef module);
+void dispose_codegen(CodeGen *codegen);
+LLVMTypeRef get_llvm_type(CodeGen *codegen, Type *type);
+void declare_functions(CodeGen *codegen, Node *program);
+void order_functions(LLVMModuleRef module, Node *program);
+LLVMValueRef generate_code(Node *node, CodeGen *codegen, SymbolTable *sym_table, LLVMBuilderRef builder);
 
 #endif // CODEGEN_H
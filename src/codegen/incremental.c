@@ -0,0 +1,127 @@
+// incremental.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <error.h>
+#include <symbol_table/symbol_table.h>
+#include "codegen.h"
+#include "incremental.h"
+
+static int compare_fingerprints_by_name(const void *a, const void *b)
+{
+    return strcmp(((const FunctionFingerprint *)a)->name, ((const FunctionFingerprint *)b)->name);
+}
+
+static FunctionFingerprint *find_fingerprint(FunctionFingerprint *fingerprints, int count, const char *name)
+{
+    FunctionFingerprint key = {(char *)name, 0};
+    return bsearch(&key, fingerprints, count, sizeof(FunctionFingerprint), compare_fingerprints_by_name);
+}
+
+// Turns a stale definition back into a bare declaration. LLVM-C cannot drop
+// a body in place, so callers are pointed at a fresh declaration and the
+// old function is deleted along with its body.
+static void discard_body(LLVMModuleRef module, LLVMValueRef func)
+{
+    size_t length;
+    char *name = strdup(LLVMGetValueName2(func, &length));
+    if (!name)
+    {
+        error_report(-1, "Memory allocation failed in discard_body.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LLVMValueRef declaration = LLVMAddFunction(module, "", LLVMGlobalGetValueType(func));
+    LLVMReplaceAllUsesWith(func, declaration);
+    LLVMDeleteFunction(func);
+    LLVMSetValueName2(declaration, name, length);
+    free(name);
+}
+
+// Regenerates `program` into `module`, which holds the unoptimized code of
+// a previous compile of the same file whose functions had the `previous`
+// fingerprints. Definitions whose fingerprint is unchanged are kept as they
+// are; every other one is discarded and generated again from the AST.
+// Returns the number of functions reused.
+int generate_incremental(LLVMModuleRef module, Node *program, int direct_ssa,
+                         FunctionFingerprint *current, int current_count,
+                         FunctionFingerprint *previous, int previous_count)
+{
+    qsort(current, current_count, sizeof(FunctionFingerprint), compare_fingerprints_by_name);
+    qsort(previous, previous_count, sizeof(FunctionFingerprint), compare_fingerprints_by_name);
+
+    char *reused = calloc(current_count ? current_count : 1, 1);
+    if (!reused)
+    {
+        error_report(-1, "Memory allocation failed in generate_incremental.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int reused_count = 0;
+    LLVMValueRef func = LLVMGetFirstFunction(module);
+    while (func)
+    {
+        LLVMValueRef next = LLVMGetNextFunction(func);
+        if (!LLVMIsDeclaration(func))
+        {
+            size_t length;
+            const char *name = LLVMGetValueName2(func, &length);
+            FunctionFingerprint *before = find_fingerprint(previous, previous_count, name);
+            FunctionFingerprint *after = find_fingerprint(current, current_count, name);
+            if (before && after && before->fingerprint == after->fingerprint)
+            {
+                reused[after - current] = 1;
+                reused_count++;
+            }
+            else
+            {
+                discard_body(module, func);
+            }
+        }
+        func = next;
+    }
+
+    // Declarations left without callers may have changed signature, so
+    // they are dropped and declared again from the source.
+    func = LLVMGetFirstFunction(module);
+    while (func)
+    {
+        LLVMValueRef next = LLVMGetNextFunction(func);
+        if (LLVMIsDeclaration(func) && !LLVMGetFirstUse(func))
+            LLVMDeleteFunction(func);
+        func = next;
+    }
+
+    CodeGen codegen;
+    init_codegen(&codegen, module);
+    codegen.direct_ssa = direct_ssa;
+    declare_functions(&codegen, program);
+
+    SymbolTable *sym_table = create_symbol_table();
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+    {
+        Node *statement = entry->as.statement_list.statement;
+        if (statement->type == AST_FUNCTION_DECL && !statement->as.function_decl.is_prototype)
+        {
+            // Only the first definition of a name is covered by the reused
+            // body; a duplicate still reaches codegen and is reported there.
+            FunctionFingerprint *fingerprint = find_fingerprint(current, current_count, statement->as.function_decl.name);
+            if (fingerprint && reused[fingerprint - current])
+            {
+                reused[fingerprint - current] = 0;
+                continue;
+            }
+        }
+        generate_code(statement, &codegen, sym_table, NULL);
+    }
+
+    // Reused bodies are still where the previous compile put them, and the
+    // regenerated ones were appended.
+    order_functions(module, program);
+
+    free_symbol_table(sym_table);
+    dispose_codegen(&codegen);
+    free(reused);
+    return reused_count;
+}
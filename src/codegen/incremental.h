@@ -0,0 +1,14 @@
+// incremental.h
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <llvm-c/Core.h>
+#include <cache/fingerprint.h>
+#include <parser/ast.h>
+
+int generate_incremental(LLVMModuleRef module, Node *program, int direct_ssa,
+                         FunctionFingerprint *current, int current_count,
+                         FunctionFingerprint *previous, int previous_count);
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,171 @@
+// partition.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Linker.h>
+#include <error.h>
+#include <optimizer/optimizer.h>
+#include <parallel/parallel.h>
+#include <target/target.h>
+#include "codegen.h"
+#include "partition.h"
+
+int count_top_level_statements(Node *program)
+{
+    int count = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+        count++;
+    return count;
+}
+
+void init_partitions(PartitionSet *set, Node *program, int partition_count, int direct_ssa, int opt_level)
+{
+    set->program = program;
+    set->statement_count = count_top_level_statements(program);
+    set->statements = malloc(sizeof(Node *) * (set->statement_count ? set->statement_count : 1));
+    set->direct_ssa = direct_ssa;
+    set->opt_level = opt_level;
+    set->object_paths = NULL;
+
+    if (partition_count > set->statement_count)
+        partition_count = set->statement_count;
+    if (partition_count < 1)
+        partition_count = 1;
+    set->partition_count = partition_count;
+    set->partitions = calloc(partition_count, sizeof(Partition));
+    if (!set->statements || !set->partitions)
+    {
+        error_report(-1, "Memory allocation failed in init_partitions.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int index = 0;
+    for (Node *entry = program; entry != NULL; entry = entry->as.statement_list.next)
+        set->statements[index++] = entry->as.statement_list.statement;
+
+    // Contiguous, near-equal runs keep source order within and across
+    // partitions, so linking them back gives the serial module's layout.
+    int first = 0;
+    for (int i = 0; i < partition_count; ++i)
+    {
+        int count = set->statement_count / partition_count + (i < set->statement_count % partition_count);
+        set->partitions[i].first_statement = first;
+        set->partitions[i].statement_count = count;
+        first += count;
+    }
+}
+
+static void generate_partition(void *context, int index)
+{
+    PartitionSet *set = (PartitionSet *)context;
+    Partition *partition = &set->partitions[index];
+
+    partition->context = LLVMContextCreate();
+    partition->module = LLVMModuleCreateWithNameInContext("module", partition->context);
+
+    CodeGen codegen;
+    init_codegen(&codegen, partition->module);
+    codegen.direct_ssa = set->direct_ssa;
+    declare_functions(&codegen, set->program);
+
+    SymbolTable *sym_table = create_symbol_table();
+    for (int i = 0; i < partition->statement_count; ++i)
+        generate_code(set->statements[partition->first_statement + i], &codegen, sym_table, NULL);
+
+    free_symbol_table(sym_table);
+    dispose_codegen(&codegen);
+}
+
+void generate_partitions(PartitionSet *set)
+{
+    parallel_for(set->partition_count, generate_partition, set);
+}
+
+static void optimize_partition(void *context, int index)
+{
+    PartitionSet *set = (PartitionSet *)context;
+    Partition *partition = &set->partitions[index];
+    optimize_module(partition->module, partition->target_machine, set->opt_level, 0);
+}
+
+void optimize_partitions(PartitionSet *set)
+{
+    // Target machines are created up front on this thread, which also keeps
+    // native target initialization off the workers.
+    for (int i = 0; i < set->partition_count; ++i)
+    {
+        Partition *partition = &set->partitions[i];
+        partition->target_machine = create_host_target_machine(set->opt_level);
+        configure_module_for_target(partition->module, partition->target_machine);
+    }
+
+    parallel_for(set->partition_count, optimize_partition, set);
+}
+
+static void emit_partition_object(void *context, int index)
+{
+    PartitionSet *set = (PartitionSet *)context;
+    Partition *partition = &set->partitions[index];
+    emit_object_file(partition->module, partition->target_machine, set->object_paths[index]);
+}
+
+void emit_partition_objects(PartitionSet *set, const char **object_paths)
+{
+    set->object_paths = object_paths;
+    parallel_for(set->partition_count, emit_partition_object, set);
+    set->object_paths = NULL;
+}
+
+// Moves every partition into `context` through an in-memory bitcode round
+// trip and links them, in order, into the first one.
+LLVMModuleRef link_partitions(PartitionSet *set, LLVMContextRef context)
+{
+    LLVMModuleRef linked = NULL;
+    for (int i = 0; i < set->partition_count; ++i)
+    {
+        Partition *partition = &set->partitions[i];
+        LLVMMemoryBufferRef bitcode = LLVMWriteBitcodeToMemoryBuffer(partition->module);
+
+        LLVMModuleRef module;
+        if (LLVMParseBitcodeInContext2(context, bitcode, &module))
+        {
+            error_report(-1, "Failed to read back the bitcode of partition %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+        LLVMDisposeMemoryBuffer(bitcode);
+
+        if (!linked)
+        {
+            linked = module;
+            LLVMSetModuleIdentifier(linked, "module", strlen("module"));
+        }
+        else if (LLVMLinkModules2(linked, module))
+        {
+            error_report(-1, "Failed to link partition %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return linked;
+}
+
+void dispose_partitions(PartitionSet *set)
+{
+    for (int i = 0; i < set->partition_count; ++i)
+    {
+        Partition *partition = &set->partitions[i];
+        if (partition->target_machine)
+            LLVMDisposeTargetMachine(partition->target_machine);
+        if (partition->module)
+            LLVMDisposeModule(partition->module);
+        if (partition->context)
+            LLVMContextDispose(partition->context);
+    }
+    free(set->partitions);
+    free(set->statements);
+    set->partitions = NULL;
+    set->statements = NULL;
+    set->partition_count = 0;
+}
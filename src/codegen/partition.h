@@ -0,0 +1,42 @@
+// partition.h
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+#include <parser/ast.h>
+
+// A contiguous run of top-level declarations generated into its own LLVM
+// context and module, so partitions can be generated, optimized and emitted
+// on separate threads.
+typedef struct
+{
+    int first_statement;
+    int statement_count;
+    LLVMContextRef context;
+    LLVMModuleRef module;
+    LLVMTargetMachineRef target_machine;
+} Partition;
+
+typedef struct
+{
+    Node *program;
+    Node **statements;
+    int statement_count;
+    Partition *partitions;
+    int partition_count;
+    int direct_ssa;
+    int opt_level;
+    const char **object_paths;
+} PartitionSet;
+
+int count_top_level_statements(Node *program);
+void init_partitions(PartitionSet *set, Node *program, int partition_count, int direct_ssa, int opt_level);
+void generate_partitions(PartitionSet *set);
+void optimize_partitions(PartitionSet *set);
+void emit_partition_objects(PartitionSet *set, const char **object_paths);
+LLVMModuleRef link_partitions(PartitionSet *set, LLVMContextRef context);
+void dispose_partitions(PartitionSet *set);
+
+#endif // PARTITION_H
@@ -0,0 +1,270 @@
+// options.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "cache/cache.h"
+#include "parallel/parallel.h"
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-O0|-O1|-O2|-O3] [-c] [--emit=ir|bc] [-o <output>] [--run] [-j <n>] [-fno-ssa] [-ftime-report[=json]]\n"
+                    "          [--cache-dir <dir>] [--cache-max-size <n>[K|M|G]] [--cache-stats] [<input>...]\n", program);
+    fprintf(stderr, "  <input>      .syro source files (default: main.syro), .bc bitcode modules, or .o files for the linker\n");
+    fprintf(stderr, "  (default)    Print the LLVM IR of all inputs, linked, to stdout\n");
+    fprintf(stderr, "  -c           Write a native object file per input\n");
+    fprintf(stderr, "  --emit=bc    Write an LLVM bitcode file per input\n");
+    fprintf(stderr, "  -o <output>  Output path; without -c or --emit=bc, link an executable\n");
+    fprintf(stderr, "  --run        JIT-compile and run main() in-process\n");
+    fprintf(stderr, "  -j <n>       Generate, optimize and emit functions on n threads (0: all cores)\n");
+    fprintf(stderr, "  -fno-ssa     Keep every local in a stack slot instead of building SSA\n");
+    fprintf(stderr, "  -ftime-report[=json]  Print per-phase timing and memory to stderr\n");
+    fprintf(stderr, "  --cache-dir <dir>     Reuse optimized modules of unchanged inputs (default: $SYROC_CACHE_DIR)\n");
+    fprintf(stderr, "  --cache-max-size <n>  Evict least recently used cache entries beyond n bytes (default: 512M)\n");
+    fprintf(stderr, "  --cache-stats         Print cache hits, misses and bytes to stderr\n");
+}
+
+static int parse_size(const char *text, uint64_t *size)
+{
+    char *end = NULL;
+    unsigned long long value = text ? strtoull(text, &end, 10) : 0;
+    if (!text || end == text)
+        return 0;
+
+    switch (*end)
+    {
+    case 'G':
+        value *= 1024;
+        // fall through
+    case 'M':
+        value *= 1024;
+        // fall through
+    case 'K':
+        value *= 1024;
+        end++;
+        break;
+    default:
+        break;
+    }
+
+    if (*end != '\0')
+        return 0;
+    *size = value;
+    return 1;
+}
+
+void parse_options(int argc, char **argv, CompilerOptions *options)
+{
+    options->input_paths = malloc(sizeof(char *) * argc);
+    if (!options->input_paths)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in parse_options.\n");
+        exit(EXIT_FAILURE);
+    }
+    options->input_count = 0;
+    options->output_path = NULL;
+    options->output_kind = OUTPUT_IR;
+    options->opt_level = 0;
+    options->direct_ssa = 1;
+    options->jobs = 1;
+    options->time_report = TIME_REPORT_NONE;
+    options->cache_dir = getenv("SYROC_CACHE_DIR");
+    options->cache_max_bytes = DEFAULT_CACHE_MAX_BYTES;
+    options->cache_stats = 0;
+    int compile_only = 0;
+    int emit_bitcode = 0;
+    int run = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+
+        if (strncmp(arg, "-O", 2) == 0)
+        {
+            if (strlen(arg) != 3 || arg[2] < '0' || arg[2] > '3')
+            {
+                fprintf(stderr, "Error: Invalid optimization level '%s'.\n", arg);
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            options->opt_level = arg[2] - '0';
+        }
+        else if (strcmp(arg, "-c") == 0)
+        {
+            compile_only = 1;
+        }
+        else if (strcmp(arg, "--emit=bc") == 0)
+        {
+            emit_bitcode = 1;
+        }
+        else if (strcmp(arg, "--emit=ir") == 0)
+        {
+            emit_bitcode = 0;
+        }
+        else if (strcmp(arg, "-fno-ssa") == 0)
+        {
+            options->direct_ssa = 0;
+        }
+        else if (strcmp(arg, "-ftime-report") == 0)
+        {
+            options->time_report = TIME_REPORT_TABLE;
+        }
+        else if (strcmp(arg, "-ftime-report=json") == 0)
+        {
+            options->time_report = TIME_REPORT_JSON;
+        }
+        else if (strcmp(arg, "--cache-dir") == 0)
+        {
+            if (i + 1 >= argc)
+            {
+                fprintf(stderr, "Error: Missing path after '--cache-dir'.\n");
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            options->cache_dir = argv[++i];
+        }
+        else if (strcmp(arg, "--cache-max-size") == 0)
+        {
+            if (!parse_size(i + 1 < argc ? argv[++i] : NULL, &options->cache_max_bytes))
+            {
+                fprintf(stderr, "Error: Invalid size after '--cache-max-size'.\n");
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(arg, "--cache-stats") == 0)
+        {
+            options->cache_stats = 1;
+        }
+        else if (strcmp(arg, "--run") == 0)
+        {
+            run = 1;
+        }
+        else if (strcmp(arg, "-o") == 0)
+        {
+            if (i + 1 >= argc)
+            {
+                fprintf(stderr, "Error: Missing path after '-o'.\n");
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            options->output_path = argv[++i];
+        }
+        else if (strncmp(arg, "-j", 2) == 0)
+        {
+            const char *count = arg[2] ? arg + 2 : (i + 1 < argc ? argv[++i] : NULL);
+            char *end = NULL;
+            long jobs = count ? strtol(count, &end, 10) : -1;
+            if (!count || *end != '\0' || jobs < 0 || jobs > 1024)
+            {
+                fprintf(stderr, "Error: Invalid job count after '-j'.\n");
+                print_usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            options->jobs = jobs == 0 ? hardware_thread_count() : (int)jobs;
+        }
+        else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0)
+        {
+            print_usage(argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        else if (arg[0] != '-')
+        {
+            options->input_paths[options->input_count++] = arg;
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown option '%s'.\n", arg);
+            print_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (run && (compile_only || emit_bitcode || options->output_path))
+    {
+        fprintf(stderr, "Error: '--run' cannot be combined with '-c', '--emit=bc' or '-o'.\n");
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (compile_only && emit_bitcode)
+    {
+        fprintf(stderr, "Error: '-c' cannot be combined with '--emit=bc'.\n");
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Both write one output file per input.
+    int per_input = compile_only || emit_bitcode;
+
+    if (options->cache_dir && !*options->cache_dir)
+        options->cache_dir = NULL;
+
+    if (options->input_count == 0)
+        options->input_paths[options->input_count++] = "main.syro";
+
+    int source_count = 0;
+    for (int i = 0; i < options->input_count; ++i)
+        source_count += !is_object_input(options->input_paths[i]);
+
+    if (per_input && options->output_path && source_count > 1)
+    {
+        fprintf(stderr, "Error: '-o' cannot be combined with '-c' or '--emit=bc' and multiple source files.\n");
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (source_count != options->input_count && (per_input || !options->output_path))
+    {
+        fprintf(stderr, "Error: Object file inputs can only be linked into an executable with '-o'.\n");
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (run)
+        options->output_kind = OUTPUT_RUN;
+    else if (compile_only)
+        options->output_kind = OUTPUT_OBJECT;
+    else if (emit_bitcode)
+        options->output_kind = OUTPUT_BITCODE;
+    else if (options->output_path)
+        options->output_kind = OUTPUT_EXECUTABLE;
+}
+
+void free_options(CompilerOptions *options)
+{
+    free(options->input_paths);
+    options->input_paths = NULL;
+    options->input_count = 0;
+}
+
+int is_object_input(const char *path)
+{
+    size_t length = strlen(path);
+    return length > 2 && strcmp(path + length - 2, ".o") == 0;
+}
+
+int is_bitcode_input(const char *path)
+{
+    size_t length = strlen(path);
+    return length > 3 && strcmp(path + length - 3, ".bc") == 0;
+}
+
+char *default_output_path(const char *input_path, const char *extension)
+{
+    const char *base = strrchr(input_path, '/');
+    base = base ? base + 1 : input_path;
+    const char *dot = strrchr(base, '.');
+    size_t stem_length = dot ? (size_t)(dot - base) : strlen(base);
+
+    char *path = malloc(stem_length + strlen(extension) + 1);
+    if (!path)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in default_output_path.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(path, base, stem_length);
+    strcpy(path + stem_length, extension);
+    return path;
+}
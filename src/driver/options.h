@@ -0,0 +1,39 @@
+// options.h
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdint.h>
+#include "timing/timing.h"
+
+typedef enum
+{
+    OUTPUT_IR,
+    OUTPUT_OBJECT,
+    OUTPUT_BITCODE,
+    OUTPUT_EXECUTABLE,
+    OUTPUT_RUN,
+} OutputKind;
+
+typedef struct
+{
+    const char **input_paths;
+    int input_count;
+    const char *output_path;
+    OutputKind output_kind;
+    int opt_level;
+    int direct_ssa;
+    int jobs;
+    TimeReportFormat time_report;
+    const char *cache_dir;
+    uint64_t cache_max_bytes;
+    int cache_stats;
+} CompilerOptions;
+
+void parse_options(int argc, char **argv, CompilerOptions *options);
+void free_options(CompilerOptions *options);
+int is_object_input(const char *path);
+int is_bitcode_input(const char *path);
+char *default_output_path(const char *input_path, const char *extension);
+
+#endif // OPTIONS_H
@@ -0,0 +1,99 @@
+// source.c
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "source.h"
+
+// Pipes and other unmappable inputs are read into a heap buffer instead.
+static void read_source_stream(SourceFile *source, int fd, const char *path)
+{
+    size_t capacity = 64 * 1024;
+    source->data = malloc(capacity);
+    source->length = 0;
+    source->mapped = 0;
+
+    for (;;)
+    {
+        if (!source->data)
+        {
+            fprintf(stderr, "Error: Failed to allocate memory for source code.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (source->length == capacity)
+        {
+            capacity *= 2;
+            source->data = realloc(source->data, capacity);
+            continue;
+        }
+
+        ssize_t result = read(fd, source->data + source->length, capacity - source->length);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+        {
+            fprintf(stderr, "Error: Could not read file %s: %s\n", path, strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        if (result == 0)
+            return;
+        source->length += (size_t)result;
+    }
+}
+
+void open_source_file(SourceFile *source, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: Could not open file %s.\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        read_source_stream(source, fd, path);
+        close(fd);
+        return;
+    }
+
+    source->length = (size_t)info.st_size;
+    source->mapped = source->length > 0;
+    if (!source->mapped)
+    {
+        // mmap rejects empty mappings; an empty file lexes as just EOF.
+        source->data = NULL;
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(NULL, source->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        read_source_stream(source, fd, path);
+        close(fd);
+        return;
+    }
+    close(fd);
+
+    // The lexer makes a single forward pass.
+    madvise(data, source->length, MADV_SEQUENTIAL);
+    source->data = data;
+}
+
+void close_source_file(SourceFile *source)
+{
+    if (source->mapped)
+        munmap(source->data, source->length);
+    else
+        free(source->data);
+    source->data = NULL;
+    source->length = 0;
+    source->mapped = 0;
+}
@@ -0,0 +1,21 @@
+// source.h
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+
+// A source file's bytes, mapped read-only where possible so the lexer reads
+// the page cache directly. The text is not NUL-terminated; consumers are
+// bounded by `length`.
+typedef struct
+{
+    char *data;
+    size_t length;
+    int mapped;
+} SourceFile;
+
+void open_source_file(SourceFile *source, const char *path);
+void close_source_file(SourceFile *source);
+
+#endif // SOURCE_H
@@ -2,13 +2,34 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <pthread.h>
+#include <setjmp.h>
 #include "error.h"
 
 #define COLOR_RED "\x1b[31m"
 #define RESET_COLOR "\x1b[0m"
 
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread jmp_buf *error_trap;
+
+// While a trap is set, errors on this thread are not printed: error_report
+// jumps back to the trap so the work can be redone where the error is
+// reported in order.
+void set_error_trap(jmp_buf *trap)
+{
+    error_trap = trap;
+}
+
+// Every error is fatal and its caller exits right after reporting it. The
+// lock is therefore never released: when worker threads fail together,
+// one message is printed and the others wait for the process to exit.
 void error_report(int line, const char *format, ...)
 {
+    if (error_trap)
+        longjmp(*error_trap, 1);
+
+    pthread_mutex_lock(&report_lock);
+
     va_list args;
     va_start(args, format);
 
@@ -3,6 +3,9 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <setjmp.h>
+
 void error_report(int line, const char *format, ...);
+void set_error_trap(jmp_buf *trap);
 
 #endif // ERROR_H
@@ -0,0 +1,85 @@
+// jit.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <llvm-c/ExecutionEngine.h>
+#include <llvm-c/Support.h>
+#include <llvm-c/Target.h>
+#include <runtime/runtime.h>
+#include "jit.h"
+
+// The runtime is compiled into syroc, so JIT-compiled code calls the same
+// routines an executable gets from libsyrort.a.
+static void register_runtime_symbols(void)
+{
+    LLVMAddSymbol("syro_print_i8", (void *)syro_print_i8);
+    LLVMAddSymbol("syro_print_i16", (void *)syro_print_i16);
+    LLVMAddSymbol("syro_print_i32", (void *)syro_print_i32);
+    LLVMAddSymbol("syro_print_i64", (void *)syro_print_i64);
+    LLVMAddSymbol("syro_print_ptr", (void *)syro_print_ptr);
+}
+
+int run_module(LLVMModuleRef module, int opt_level)
+{
+    LLVMLinkInMCJIT();
+    register_runtime_symbols();
+    if (LLVMInitializeNativeTarget() || LLVMInitializeNativeAsmPrinter())
+    {
+        fprintf(stderr, "Error: Failed to initialize the native target.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LLVMValueRef main_func = LLVMGetNamedFunction(module, "main");
+    LLVMTypeRef main_return_type = LLVMGetReturnType(LLVMGetElementType(LLVMTypeOf(main_func)));
+    int return_width = 0;
+    if (LLVMGetTypeKind(main_return_type) == LLVMIntegerTypeKind)
+        return_width = (int)LLVMGetIntTypeWidth(main_return_type);
+
+    struct LLVMMCJITCompilerOptions jit_options;
+    LLVMInitializeMCJITCompilerOptions(&jit_options, sizeof(jit_options));
+    jit_options.OptLevel = (unsigned)opt_level;
+
+    // The engine takes ownership of the module. External symbols are
+    // resolved against the running syroc process.
+    LLVMExecutionEngineRef engine;
+    char *error = NULL;
+    if (LLVMCreateMCJITCompilerForModule(&engine, module, &jit_options, sizeof(jit_options), &error))
+    {
+        fprintf(stderr, "Error: Failed to create JIT: %s\n", error);
+        LLVMDisposeMessage(error);
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t main_address = LLVMGetFunctionAddress(engine, "main");
+    if (!main_address)
+    {
+        fprintf(stderr, "Error: Failed to JIT-compile 'main'.\n");
+        LLVMDisposeExecutionEngine(engine);
+        exit(EXIT_FAILURE);
+    }
+
+    int exit_code = 0;
+    if (return_width > 0)
+    {
+        int64_t (*main_entry)(void) = (int64_t(*)(void))(uintptr_t)main_address;
+        int64_t result = main_entry();
+        if (return_width == 8)
+            exit_code = (int8_t)result;
+        else if (return_width == 16)
+            exit_code = (int16_t)result;
+        else
+            exit_code = (int32_t)result;
+    }
+    else
+    {
+        void (*main_entry)(void) = (void (*)(void))(uintptr_t)main_address;
+        main_entry();
+    }
+
+    syro_flush();
+    fflush(stdout);
+    LLVMDisposeExecutionEngine(engine);
+
+    return exit_code;
+}
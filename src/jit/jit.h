@@ -0,0 +1,10 @@
+// jit.h
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <llvm-c/Core.h>
+
+int run_module(LLVMModuleRef module, int opt_level);
+
+#endif // JIT_H
@@ -0,0 +1,124 @@
+// intern.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "intern.h"
+#include "error.h"
+#include "memory/arena.h"
+
+#define INITIAL_INTERN_CAPACITY 64
+#define INTERN_SHARD_BITS 6
+#define INTERN_SHARDS (1 << INTERN_SHARD_BITS)
+
+typedef struct
+{
+    char *text;
+    int length;
+    unsigned int hash;
+} InternEntry;
+
+typedef struct
+{
+    InternEntry *entries;
+    int capacity;
+    int count;
+    Arena storage;
+    pthread_mutex_t lock;
+} InternTable;
+
+// The table is split into shards picked by the top bits of the hash, each
+// with its own lock, so parser threads rarely wait on one another.
+static InternTable shards[INTERN_SHARDS] = {
+    [0 ... INTERN_SHARDS - 1] = {.lock = PTHREAD_MUTEX_INITIALIZER},
+};
+
+static unsigned int hash_text(const char *text, int length)
+{
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static InternEntry *find_entry(InternEntry *entries, int capacity, const char *text, int length, unsigned int hash)
+{
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int index = hash & mask;
+    for (;;)
+    {
+        InternEntry *entry = &entries[index];
+        if (!entry->text ||
+            (entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0))
+            return entry;
+        index = (index + 1) & mask;
+    }
+}
+
+static void grow_table(InternTable *table)
+{
+    int capacity = table->capacity ? table->capacity * 2 : INITIAL_INTERN_CAPACITY;
+    InternEntry *entries = calloc(capacity, sizeof(InternEntry));
+    if (!entries)
+    {
+        pthread_mutex_unlock(&table->lock);
+        error_report(-1, "Memory allocation failed in intern_string.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < table->capacity; ++i)
+    {
+        InternEntry *entry = &table->entries[i];
+        if (entry->text)
+            *find_entry(entries, capacity, entry->text, entry->length, entry->hash) = *entry;
+    }
+
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+}
+
+char *intern_string(const char *text, int length)
+{
+    unsigned int hash = hash_text(text, length);
+    InternTable *table = &shards[hash >> (32 - INTERN_SHARD_BITS)];
+    pthread_mutex_lock(&table->lock);
+
+    if (!table->entries)
+        init_arena(&table->storage);
+
+    if ((table->count + 1) * 2 > table->capacity)
+        grow_table(table);
+
+    InternEntry *entry = find_entry(table->entries, table->capacity, text, length, hash);
+    if (!entry->text)
+    {
+        entry->text = arena_strndup(&table->storage, text, length);
+        entry->length = length;
+        entry->hash = hash;
+        table->count++;
+    }
+
+    char *interned = entry->text;
+    pthread_mutex_unlock(&table->lock);
+    return interned;
+}
+
+void free_interned_strings(void)
+{
+    for (int i = 0; i < INTERN_SHARDS; ++i)
+    {
+        InternTable *table = &shards[i];
+        if (!table->entries)
+            continue;
+        free(table->entries);
+        free_arena(&table->storage);
+        table->entries = NULL;
+        table->capacity = 0;
+        table->count = 0;
+    }
+}
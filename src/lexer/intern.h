@@ -0,0 +1,13 @@
+// intern.h
+
+#ifndef INTERN_H
+#define INTERN_H
+
+// Process-wide string interner. Every distinct lexeme is stored once and
+// identified by its canonical pointer, so names can be compared with ==.
+// Keywords are recognized by the lexer and never reach the table.
+// intern_string may be called from several threads at once.
+char *intern_string(const char *text, int length);
+void free_interned_strings(void);
+
+#endif // INTERN_H
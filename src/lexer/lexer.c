@@ -2,47 +2,83 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
-#include <ctype.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "lexer.h"
+#include "intern.h"
 #include "error.h"
+#include "parallel/parallel.h"
 
-void init_lexer(Lexer *lexer, char *source)
+#define CHAR_DIGIT 0x01
+#define CHAR_IDENT_START 0x02
+#define CHAR_IDENT 0x04
+#define CHAR_SPACE 0x08
+
+// One lookup classifies a byte; bytes outside ASCII have no class.
+static const unsigned char char_class[256] = {
+    [' '] = CHAR_SPACE,
+    ['\t'] = CHAR_SPACE,
+    ['\r'] = CHAR_SPACE,
+    ['\n'] = CHAR_SPACE,
+    ['0' ... '9'] = CHAR_DIGIT | CHAR_IDENT,
+    ['A' ... 'Z'] = CHAR_IDENT_START | CHAR_IDENT,
+    ['a' ... 'z'] = CHAR_IDENT_START | CHAR_IDENT,
+    ['_'] = CHAR_IDENT_START | CHAR_IDENT,
+};
+
+// The source need not be NUL-terminated: every read is bounded by `end`, so
+// tokens can point straight into a read-only mapping of the file.
+void init_lexer(Lexer *lexer, char *source, size_t length, Arena *arena)
 {
+    lexer->source = source;
+    lexer->arena = arena;
     lexer->start = source;
     lexer->current_position = source;
+    lexer->end = source + length;
     lexer->line = 1;
+    lexer->tokens = NULL;
+    lexer->token_count = 0;
+    lexer->token_index = 0;
     scan_token(lexer);
 }
 
-TokenType check_keyword(char *start, int length)
-{
-    if (length == 2 && strncmp(start, "i8", 2) == 0)
-        return TOKEN_I8;
-    if (length == 3 && strncmp(start, "i16", 3) == 0)
-        return TOKEN_I16;
-    if (length == 3 && strncmp(start, "i32", 3) == 0)
-        return TOKEN_I32;
-    if (length == 3 && strncmp(start, "i64", 3) == 0)
-        return TOKEN_I64;
-    if (length == 4 && strncmp(start, "void", 4) == 0)
-        return TOKEN_VOID;
-    if (length == 6 && strncmp(start, "return", 6) == 0)
-        return TOKEN_RETURN;
-    if (length == 5 && strncmp(start, "print", 5) == 0)
-        return TOKEN_PRINT;
-    if (length == 2 && strncmp(start, "if", 2) == 0)
-        return TOKEN_IF;
-    if (length == 4 && strncmp(start, "else", 4) == 0)
-        return TOKEN_ELSE;
-    if (length == 5 && strncmp(start, "while", 5) == 0)
-        return TOKEN_WHILE;
-    if (length == 3 && strncmp(start, "for", 3) == 0)
-        return TOKEN_FOR;
-    if (length == 9 && strncmp(start, "undefined", 9) == 0)
-        return TOKEN_UNDEFINED;
+static Token token_at(Lexer *lexer, int index);
 
-    return TOKEN_IDENTIFIER;
+// Lexes the entire source up front so the parser can look ahead freely.
+// Sources too large for 32-bit token offsets are lexed on demand instead.
+void init_token_lexer(Lexer *lexer, char *source, size_t length, Arena *arena, int threads)
+{
+    if (length > UINT32_MAX)
+    {
+        init_lexer(lexer, source, length, arena);
+        return;
+    }
+
+    lexer->source = source;
+    lexer->arena = arena;
+    lexer->start = source;
+    lexer->current_position = source;
+    lexer->end = source + length;
+    lexer->tokens = tokenize(source, length, threads, &lexer->token_count);
+    seek_token(lexer, 0);
+}
+
+// Moves a buffered lexer to the token at `index`.
+void seek_token(Lexer *lexer, int index)
+{
+    lexer->token_index = index < lexer->token_count ? index : lexer->token_count - 1;
+    lexer->current_token = token_at(lexer, lexer->token_index);
+    lexer->line = lexer->current_token.line;
+}
+
+void dispose_lexer(Lexer *lexer)
+{
+    free(lexer->tokens);
+    lexer->tokens = NULL;
+    lexer->token_count = 0;
 }
 
 Token make_token(Lexer *lexer, TokenType type)
@@ -50,6 +86,7 @@ Token make_token(Lexer *lexer, TokenType type)
     Token token;
     token.type = type;
     token.lexeme = lexer->start;
+    token.name = NULL;
     token.length = (int)(lexer->current_position - lexer->start);
     token.line = lexer->line;
     return token;
@@ -63,183 +100,517 @@ char advance(Lexer *lexer)
 
 char peek(Lexer *lexer)
 {
+    if (is_at_end(lexer))
+        return '\0';
     return *lexer->current_position;
 }
 
 char peek_next(Lexer *lexer)
 {
-    if (is_at_end(lexer))
+    if (lexer->end - lexer->current_position < 2)
         return '\0';
     return lexer->current_position[1];
 }
 
 int is_at_end(Lexer *lexer)
 {
-    return *lexer->current_position == '\0';
+    return lexer->current_position >= lexer->end;
+}
+
+// Returns how many spaces open the eight bytes at `p`. Indentation comes in
+// long runs of spaces, which this skips a word at a time.
+static inline int count_spaces(const char *p)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    uint64_t other = word ^ 0x2020202020202020ull;
+    return other ? __builtin_ctzll(other) >> 3 : 8;
+#else
+    return *p == ' ';
+#endif
 }
 
 void skip_whitespace(Lexer *lexer)
 {
+    char *p = lexer->current_position;
+    char *end = lexer->end;
+    int line = lexer->line;
+
     for (;;)
     {
-        char c = peek(lexer);
-        switch (c)
+        while (end - p >= 8)
         {
-        case ' ':
-        case '\r':
-        case '\t':
-            advance(lexer);
+            int spaces = count_spaces(p);
+            p += spaces;
+            if (spaces < 8)
+                break;
+        }
+
+        if (p >= end || !(char_class[(unsigned char)*p] & CHAR_SPACE))
             break;
-        case '\n':
-            lexer->line++;
-            advance(lexer);
+        line += *p == '\n';
+        p++;
+    }
+
+    lexer->current_position = p;
+    lexer->line = line;
+}
+
+// Returns the end of the identifier that continues at `p`.
+static char *scan_identifier_tail(char *p, char *end)
+{
+#ifdef __SSE2__
+    // Sixteen bytes are classified at once with signed compares; bytes
+    // above 0x7f are negative and fall outside every range.
+    const __m128i digit_low = _mm_set1_epi8('0' - 1);
+    const __m128i digit_high = _mm_set1_epi8('9' + 1);
+    const __m128i alpha_low = _mm_set1_epi8('a' - 1);
+    const __m128i alpha_high = _mm_set1_epi8('z' + 1);
+    const __m128i lower_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+
+    while (end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i lower = _mm_or_si128(chunk, lower_bit);
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, digit_low), _mm_cmpgt_epi8(digit_high, chunk));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, alpha_low), _mm_cmpgt_epi8(alpha_high, lower));
+        __m128i ident = _mm_or_si128(_mm_or_si128(digit, alpha), _mm_cmpeq_epi8(chunk, underscore));
+
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(ident) & 0xffff;
+        if (mask)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+
+    while (p < end && (char_class[(unsigned char)*p] & CHAR_IDENT))
+        p++;
+    return p;
+}
+
+// Keywords are matched on length and first byte before one memcmp, so an
+// identifier that is not a keyword usually costs a single compare.
+static TokenType match_keyword(const char *text, int length)
+{
+#define KEYWORD(word, type) (memcmp(text, word, length) == 0 ? (type) : TOKEN_IDENTIFIER)
+    switch (length)
+    {
+    case 2:
+        switch (text[0])
+        {
+        case 'i':
+            return text[1] == '8' ? TOKEN_I8 : text[1] == 'f' ? TOKEN_IF : TOKEN_IDENTIFIER;
+        }
+        break;
+    case 3:
+        switch (text[0])
+        {
+        case 'i':
+            if (text[1] == '1' && text[2] == '6')
+                return TOKEN_I16;
+            if (text[1] == '3' && text[2] == '2')
+                return TOKEN_I32;
+            if (text[1] == '6' && text[2] == '4')
+                return TOKEN_I64;
             break;
-        default:
-            return;
+        case 'f':
+            return KEYWORD("for", TOKEN_FOR);
+        }
+        break;
+    case 4:
+        switch (text[0])
+        {
+        case 'v':
+            return KEYWORD("void", TOKEN_VOID);
+        case 'e':
+            return KEYWORD("else", TOKEN_ELSE);
+        }
+        break;
+    case 5:
+        switch (text[0])
+        {
+        case 'p':
+            return KEYWORD("print", TOKEN_PRINT);
+        case 'w':
+            return KEYWORD("while", TOKEN_WHILE);
         }
+        break;
+    case 6:
+        if (text[0] == 'r')
+            return KEYWORD("return", TOKEN_RETURN);
+        break;
+    case 9:
+        if (text[0] == 'u')
+            return KEYWORD("undefined", TOKEN_UNDEFINED);
+        break;
     }
+    return TOKEN_IDENTIFIER;
+#undef KEYWORD
 }
 
-Token scan_token(Lexer *lexer)
+// Scans the next token and returns its type, leaving its bytes between
+// lexer->start and lexer->current_position. An unexpected character is
+// returned as TOKEN_ERROR rather than reported, since a chunk being lexed
+// on a worker thread does not yet know its line numbers.
+static TokenType scan_type(Lexer *lexer)
 {
     skip_whitespace(lexer);
 
     lexer->start = lexer->current_position;
 
     if (is_at_end(lexer))
-    {
-        lexer->current_token = make_token(lexer, TOKEN_EOF);
-        return lexer->current_token;
-    }
+        return TOKEN_EOF;
 
     char c = advance(lexer);
+    unsigned char class = char_class[(unsigned char)c];
 
-    if (isdigit(c))
+    if (class & CHAR_DIGIT)
     {
-        while (isdigit(peek(lexer)))
-            advance(lexer);
-
-        lexer->current_token = make_token(lexer, TOKEN_NUMBER);
-        return lexer->current_token;
+        char *p = lexer->current_position;
+        while (p < lexer->end && (char_class[(unsigned char)*p] & CHAR_DIGIT))
+            p++;
+        lexer->current_position = p;
+        return TOKEN_NUMBER;
     }
 
-    if (isalpha(c) || c == '_')
+    if (class & CHAR_IDENT_START)
     {
-        while (isalnum(peek(lexer)) || peek(lexer) == '_')
-            advance(lexer);
-
-        int length = (int)(lexer->current_position - lexer->start);
-        lexer->current_token = make_token(lexer, check_keyword(lexer->start, length));
-        return lexer->current_token;
+        lexer->current_position = scan_identifier_tail(lexer->current_position, lexer->end);
+        return match_keyword(lexer->start, (int)(lexer->current_position - lexer->start));
     }
 
     switch (c)
     {
     case '+':
-        lexer->current_token = make_token(lexer, TOKEN_PLUS);
-        break;
+        return TOKEN_PLUS;
     case '-':
         if (peek(lexer) == '>')
         {
             advance(lexer);
-            lexer->current_token = make_token(lexer, TOKEN_ARROW);
-        }
-        else
-        {
-            lexer->current_token = make_token(lexer, TOKEN_MINUS);
+            return TOKEN_ARROW;
         }
-        break;
+        return TOKEN_MINUS;
     case '*':
-        lexer->current_token = make_token(lexer, TOKEN_STAR);
-        break;
+        return TOKEN_STAR;
     case '/':
-        lexer->current_token = make_token(lexer, TOKEN_SLASH);
-        break;
+        return TOKEN_SLASH;
     case '&':
-        lexer->current_token = make_token(lexer, TOKEN_AMPERSAND);
-        break;
+        return TOKEN_AMPERSAND;
     case '=':
         if (peek(lexer) == '=')
         {
             advance(lexer);
-            lexer->current_token = make_token(lexer, TOKEN_EQUAL_EQUAL);
-        }
-        else
-        {
-            lexer->current_token = make_token(lexer, TOKEN_EQUAL);
+            return TOKEN_EQUAL_EQUAL;
         }
-        break;
+        return TOKEN_EQUAL;
     case '!':
         if (peek(lexer) == '=')
         {
             advance(lexer);
-            lexer->current_token = make_token(lexer, TOKEN_BANG_EQUAL);
-        }
-        else
-        {
-            error_report(lexer->line, "Unexpected character '!'");
-            exit(EXIT_FAILURE);
+            return TOKEN_BANG_EQUAL;
         }
-        break;
+        return TOKEN_ERROR;
     case '<':
         if (peek(lexer) == '=')
         {
             advance(lexer);
-            lexer->current_token = make_token(lexer, TOKEN_LESS_EQUAL);
+            return TOKEN_LESS_EQUAL;
         }
-        else
-        {
-            lexer->current_token = make_token(lexer, TOKEN_LESS);
-        }
-        break;
+        return TOKEN_LESS;
     case '>':
         if (peek(lexer) == '=')
         {
             advance(lexer);
-            lexer->current_token = make_token(lexer, TOKEN_GREATER_EQUAL);
+            return TOKEN_GREATER_EQUAL;
         }
-        else
-        {
-            lexer->current_token = make_token(lexer, TOKEN_GREATER);
-        }
-        break;
+        return TOKEN_GREATER;
     case '(':
-        lexer->current_token = make_token(lexer, TOKEN_LPAREN);
-        break;
+        return TOKEN_LPAREN;
     case ')':
-        lexer->current_token = make_token(lexer, TOKEN_RPAREN);
-        break;
+        return TOKEN_RPAREN;
     case '{':
-        lexer->current_token = make_token(lexer, TOKEN_LBRACE);
-        break;
+        return TOKEN_LBRACE;
     case '}':
-        lexer->current_token = make_token(lexer, TOKEN_RBRACE);
-        break;
+        return TOKEN_RBRACE;
     case '[':
-        lexer->current_token = make_token(lexer, TOKEN_LBRACKET);
-        break;
+        return TOKEN_LBRACKET;
     case ']':
-        lexer->current_token = make_token(lexer, TOKEN_RBRACKET);
-        break;
+        return TOKEN_RBRACKET;
     case ',':
-        lexer->current_token = make_token(lexer, TOKEN_COMMA);
-        break;
+        return TOKEN_COMMA;
     case ';':
-        lexer->current_token = make_token(lexer, TOKEN_SEMI);
-        break;
+        return TOKEN_SEMI;
     case ':':
-        lexer->current_token = make_token(lexer, TOKEN_COLON);
-        break;
+        return TOKEN_COLON;
     case '@':
-        lexer->current_token = make_token(lexer, TOKEN_AT);
-        break;
+        return TOKEN_AT;
     case '|':
-        lexer->current_token = make_token(lexer, TOKEN_PIPE);
-        break;
+        return TOKEN_PIPE;
     default:
-        error_report(lexer->line, "Unexpected character '%c'", c);
-        exit(EXIT_FAILURE);
+        return TOKEN_ERROR;
     }
+}
+
+static void report_unexpected_character(int line, char c)
+{
+    error_report(line, "Unexpected character '%c'", c);
+    exit(EXIT_FAILURE);
+}
+
+// Expands a buffered token into the form the parser consumes.
+static Token token_at(Lexer *lexer, int index)
+{
+    if (index >= lexer->token_count)
+        index = lexer->token_count - 1;
 
+    LexedToken *lexed = &lexer->tokens[index];
+    Token token;
+    token.type = lexed->type;
+    token.lexeme = lexer->source + lexed->offset;
+    token.name = lexed->name;
+    token.length = (int)lexed->length;
+    token.line = (int)lexed->line;
+    return token;
+}
+
+Token scan_token(Lexer *lexer)
+{
+    if (lexer->tokens)
+    {
+        if (lexer->token_index < lexer->token_count - 1)
+            lexer->token_index++;
+        lexer->current_token = token_at(lexer, lexer->token_index);
+        lexer->line = lexer->current_token.line;
+        return lexer->current_token;
+    }
+
+    TokenType type = scan_type(lexer);
+    if (type == TOKEN_ERROR)
+        report_unexpected_character(lexer->line, *lexer->start);
+
+    lexer->current_token = make_token(lexer, type);
+    if (type == TOKEN_IDENTIFIER)
+        lexer->current_token.name = intern_string(lexer->start, lexer->current_token.length);
     return lexer->current_token;
 }
+
+// Returns the token `distance` places after the current one without
+// consuming anything; past the end of input it is TOKEN_EOF. Indexing the
+// buffer is O(1). An on-demand lexer scans ahead on a copy of itself.
+Token peek_token(Lexer *lexer, int distance)
+{
+    if (lexer->tokens)
+        return token_at(lexer, lexer->token_index + distance);
+
+    Lexer ahead = *lexer;
+    for (int i = 0; i < distance && ahead.current_token.type != TOKEN_EOF; ++i)
+        scan_token(&ahead);
+    return ahead.current_token;
+}
+
+#define MIN_CHUNK_BYTES (256 * 1024)
+
+// One newline-aligned slice of the source, lexed on its own thread. Lines
+// are counted from 1 within the chunk and rebased when chunks are joined.
+typedef struct
+{
+    char *start;
+    char *end;
+    LexedToken *tokens;
+    int count;
+    int capacity;
+    int newlines;
+    char *error;
+    int error_line;
+    int first_token;
+    unsigned int first_line;
+} TokenChunk;
+
+typedef struct
+{
+    char *source;
+    TokenChunk *chunks;
+    LexedToken *tokens;
+} TokenizeContext;
+
+static void lex_chunk(void *context, int index)
+{
+    TokenizeContext *tokenize_context = (TokenizeContext *)context;
+    TokenChunk *chunk = &tokenize_context->chunks[index];
+
+    Lexer lexer = {0};
+    lexer.start = chunk->start;
+    lexer.current_position = chunk->start;
+    lexer.end = chunk->end;
+    lexer.line = 1;
+
+    // Source text averages well over four bytes per token, so the first
+    // guess rarely has to grow. One slot is kept spare for the EOF token.
+    chunk->capacity = (int)((chunk->end - chunk->start) / 4) + 16;
+    chunk->tokens = malloc(sizeof(LexedToken) * chunk->capacity);
+    if (!chunk->tokens)
+    {
+        error_report(-1, "Memory allocation failed in tokenize.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (;;)
+    {
+        TokenType type = scan_type(&lexer);
+        if (type == TOKEN_EOF)
+            break;
+        if (type == TOKEN_ERROR)
+        {
+            chunk->error = lexer.start;
+            chunk->error_line = lexer.line;
+            break;
+        }
+
+        if (chunk->count + 1 == chunk->capacity)
+        {
+            chunk->capacity *= 2;
+            chunk->tokens = realloc(chunk->tokens, sizeof(LexedToken) * chunk->capacity);
+            if (!chunk->tokens)
+            {
+                error_report(-1, "Memory allocation failed in tokenize.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        LexedToken *token = &chunk->tokens[chunk->count++];
+        token->offset = (unsigned int)(lexer.start - tokenize_context->source);
+        token->length = (unsigned int)(lexer.current_position - lexer.start);
+        token->line = (unsigned int)lexer.line;
+        token->type = type;
+        token->name = type == TOKEN_IDENTIFIER ? intern_string(lexer.start, (int)token->length) : NULL;
+    }
+    chunk->newlines = lexer.line - 1;
+}
+
+// Copies a chunk into its place in the joined array, rebasing its lines.
+static void join_chunk(void *context, int index)
+{
+    TokenizeContext *tokenize_context = (TokenizeContext *)context;
+    TokenChunk *chunk = &tokenize_context->chunks[index];
+    LexedToken *out = tokenize_context->tokens + chunk->first_token;
+    unsigned int rebase = chunk->first_line;
+
+    for (int i = 0; i < chunk->count; ++i)
+    {
+        out[i] = chunk->tokens[i];
+        out[i].line += rebase;
+    }
+    free(chunk->tokens);
+}
+
+// Lexes the whole source into one contiguous array ending in TOKEN_EOF and
+// stores its length in *count. With threads > 1, a large source is split
+// into chunks at newlines, which no token spans, and the chunks are lexed
+// in parallel and joined in order. Offsets must fit in 32 bits.
+LexedToken *tokenize(char *source, size_t length, int threads, int *count)
+{
+    int chunk_count = threads > 1 ? (int)(length / MIN_CHUNK_BYTES) : 1;
+    if (chunk_count > threads)
+        chunk_count = threads;
+    if (chunk_count < 1)
+        chunk_count = 1;
+
+    TokenChunk *chunks = calloc(chunk_count, sizeof(TokenChunk));
+    if (!chunks)
+    {
+        error_report(-1, "Memory allocation failed in tokenize.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char *end = source + length;
+    char *start = source;
+    for (int i = 0; i < chunk_count; ++i)
+    {
+        char *split = end;
+        if (i + 1 < chunk_count)
+        {
+            char *target = source + length / chunk_count * (i + 1);
+            if (target < start)
+                target = start;
+            char *newline = memchr(target, '\n', (size_t)(end - target));
+            split = newline ? newline + 1 : end;
+        }
+        chunks[i].start = start;
+        chunks[i].end = split;
+        start = split;
+    }
+
+    TokenizeContext context = {source, chunks, NULL};
+    if (chunk_count > 1)
+        parallel_for(chunk_count, lex_chunk, &context);
+    else
+        lex_chunk(&context, 0);
+
+    // The first error in source order is the one a sequential lex would
+    // have stopped at.
+    int line_base = 0;
+    int total = 0;
+    for (int i = 0; i < chunk_count; ++i)
+    {
+        if (chunks[i].error)
+            report_unexpected_character(line_base + chunks[i].error_line, *chunks[i].error);
+        chunks[i].first_token = total;
+        chunks[i].first_line = (unsigned int)line_base;
+        line_base += chunks[i].newlines;
+        total += chunks[i].count;
+    }
+
+    LexedToken *tokens;
+    if (chunk_count == 1)
+    {
+        tokens = chunks[0].tokens;
+    }
+    else
+    {
+        tokens = malloc(sizeof(LexedToken) * (total + 1));
+        if (!tokens)
+        {
+            error_report(-1, "Memory allocation failed in tokenize.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        context.tokens = tokens;
+        parallel_for(chunk_count, join_chunk, &context);
+    }
+
+    LexedToken *eof = &tokens[total];
+    eof->offset = (unsigned int)length;
+    eof->length = 0;
+    eof->line = (unsigned int)line_base + 1;
+    eof->type = TOKEN_EOF;
+    eof->name = NULL;
+
+    free(chunks);
+    *count = total + 1;
+    return tokens;
+}
+
+// Number tokens are not followed by a terminator, so they are converted
+// from their digits rather than with atoi. Out-of-range values wrap.
+int token_int_value(Token token)
+{
+    unsigned int value = 0;
+    for (int i = 0; i < token.length; ++i)
+        value = value * 10 + (unsigned int)(token.lexeme[i] - '0');
+    return (int)value;
+}
+
+int lex_all_tokens(char *source, size_t length)
+{
+    Lexer lexer;
+    init_lexer(&lexer, source, length, NULL);
+    int count = 1;
+    while (lexer.current_token.type != TOKEN_EOF)
+    {
+        scan_token(&lexer);
+        count++;
+    }
+    return count;
+}
@@ -3,22 +3,51 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stddef.h>
 #include "tokens.h"
+#include "memory/arena.h"
 
+// A token as stored in a pre-tokenized buffer, addressed by its offset into
+// the source. Identifiers are interned once, as they are lexed, so reading
+// a token back is a plain load however often the parser peeks at it.
 typedef struct
 {
+    unsigned int offset;
+    unsigned int length;
+    unsigned int line;
+    TokenType type;
+    char *name;
+} LexedToken;
+
+// Scans on demand by default. After init_token_lexer the whole source has
+// been lexed into `tokens`, which scan_token walks and peek_token indexes.
+typedef struct
+{
+    char *source;
     char *start;
     char *current_position;
+    char *end;
     int line;
     Token current_token;
+    Arena *arena;
+    LexedToken *tokens;
+    int token_count;
+    int token_index;
 } Lexer;
 
-void init_lexer(Lexer *lexer, char *source);
+void init_lexer(Lexer *lexer, char *source, size_t length, Arena *arena);
+void init_token_lexer(Lexer *lexer, char *source, size_t length, Arena *arena, int threads);
+void seek_token(Lexer *lexer, int index);
+void dispose_lexer(Lexer *lexer);
+LexedToken *tokenize(char *source, size_t length, int threads, int *count);
 Token scan_token(Lexer *lexer);
+Token peek_token(Lexer *lexer, int distance);
 Token make_token(Lexer *lexer, TokenType type);
 Token number(Lexer *lexer);
 char advance(Lexer *lexer);
 char peek(Lexer *lexer);
 int is_at_end(Lexer *lexer);
+int lex_all_tokens(char *source, size_t length);
+int token_int_value(Token token);
 
 #endif // LEXER_H
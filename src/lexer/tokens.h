@@ -46,13 +46,15 @@ typedef enum
     TOKEN_FOR,
     TOKEN_UNDEFINED,
 
-    TOKEN_EOF
+    TOKEN_EOF,
+    TOKEN_ERROR
 } TokenType;
 
 typedef struct
 {
     TokenType type;
     char *lexeme;
+    char *name;
     int length;
     int line;
 } Token;
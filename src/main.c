@@ -2,107 +2,458 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <llvm-c/Linker.h>
+#include "cache/cache.h"
 #include "codegen/codegen.h"
+#include "codegen/incremental.h"
+#include "codegen/partition.h"
+#include "driver/options.h"
+#include "driver/source.h"
+#include "jit/jit.h"
+#include "lexer/intern.h"
 #include "lexer/lexer.h"
+#include "memory/arena.h"
+#include "optimizer/fold.h"
+#include "optimizer/optimizer.h"
 #include "parser/ast.h"
+#include "parser/parallel_parse.h"
 #include "symbol_table/symbol_table.h"
+#include "target/target.h"
+#include "timing/timing.h"
 
-int main()
+// One source file compiled to its own module in the shared context or, with
+// -j, to a set of partitions that each own a context.
+typedef struct
 {
-    FILE *file = fopen("main.syro", "r");
-    if (!file)
+    const char *path;
+    LLVMModuleRef module;
+    PartitionSet partitions;
+    int parallel;
+} CompileUnit;
+
+// Stores the unit as a module entry or, given fingerprints, as the function
+// entry for its path. Partitions live in their own contexts, so they are
+// linked into a scratch context just long enough to serialize them.
+static void store_unit(CompileUnit *unit, ModuleCache *cache, uint64_t key,
+                       FunctionFingerprint *fingerprints, int fingerprint_count)
+{
+    LLVMContextRef context = NULL;
+    LLVMModuleRef module = unit->module;
+    if (unit->parallel)
     {
-        fprintf(stderr, "Error: Could not open file main.syro.\n");
-        exit(EXIT_FAILURE);
+        context = LLVMContextCreate();
+        module = link_partitions(&unit->partitions, context);
     }
 
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
+    if (fingerprints)
+        function_cache_store(cache, key, module, fingerprints, fingerprint_count);
+    else
+        module_cache_store(cache, key, module);
 
-    char *source = (char *)malloc(file_size + 1);
-    if (!source)
+    if (context)
     {
-        fprintf(stderr, "Error: Failed to allocate memory for source code.\n");
-        fclose(file);
-        exit(EXIT_FAILURE);
+        LLVMDisposeModule(module);
+        LLVMContextDispose(context);
+    }
+}
+
+// Reloads the unoptimized module left by the previous compile of this path
+// and regenerates only the functions whose fingerprints changed.
+static void generate_from_function_cache(CompileUnit *unit, Node *ast, LLVMContextRef context, ModuleCache *cache,
+                                         uint64_t key, FunctionFingerprint *fingerprints, int fingerprint_count,
+                                         int direct_ssa)
+{
+    FunctionFingerprint *previous = NULL;
+    int previous_count = 0;
+    unit->module = function_cache_lookup(cache, key, context, &previous, &previous_count);
+    if (!unit->module)
+        return;
+
+    int reused = generate_incremental(unit->module, ast, direct_ssa, fingerprints, fingerprint_count,
+                                      previous, previous_count);
+    cache->functions_reused += reused;
+    cache->functions_generated += fingerprint_count - reused;
+    free_function_fingerprints(previous, previous_count);
+}
+
+static void compile_unit(CompileUnit *unit, LLVMContextRef context, LLVMTargetMachineRef target_machine,
+                         ModuleCache *cache, CompilerOptions *options, TimeReport *report)
+{
+    // Precompiled bitcode is taken as it is and only linked or emitted.
+    if (is_bitcode_input(unit->path))
+    {
+        begin_phase(report, "read");
+        unit->module = read_bitcode_file(context, unit->path);
+        unit->parallel = 0;
+        end_phase(report);
+        return;
     }
 
-    fread(source, 1, file_size, file);
-    source[file_size] = '\0';
-    fclose(file);
+    begin_phase(report, "read");
+    SourceFile source;
+    open_source_file(&source, unit->path);
+    end_phase(report);
+
+    // A hit hands back the optimized module, skipping everything below.
+    uint64_t cache_key = 0;
+    if (cache)
+    {
+        begin_phase(report, "cache");
+        cache_key = module_cache_key(cache, source.data, source.length);
+        unit->module = module_cache_lookup(cache, cache_key, context);
+        unit->parallel = 0;
+        end_phase(report);
+
+        if (unit->module)
+        {
+            close_source_file(&source);
+            return;
+        }
+    }
+
+    // The whole file is lexed before parsing, in newline-aligned chunks
+    // spread over the -j threads when it is large enough.
+    begin_phase(report, "lex");
+    Arena arena;
+    init_arena(&arena);
 
     Lexer lexer;
-    init_lexer(&lexer, source);
+    init_token_lexer(&lexer, source.data, source.length, &arena, options->jobs);
+    end_phase(report);
 
-    Node *ast = parse_statement_list(&lexer);
+    // With -j, top-level declarations are parsed on separate threads.
+    begin_phase(report, "parse");
+    Node *ast = parse_program(&lexer, options->jobs);
+    dispose_lexer(&lexer);
     if (!ast)
     {
-        fprintf(stderr, "Error: Failed to parse AST.\n");
-        free(source);
+        fprintf(stderr, "Error: Failed to parse AST in %s.\n", unit->path);
+        free_arena(&arena);
+        close_source_file(&source);
         exit(EXIT_FAILURE);
     }
+    end_phase(report);
+
+    begin_phase(report, "fold");
+    ast = fold_constants(&arena, ast);
+    end_phase(report);
 
-    LLVMModuleRef module = LLVMModuleCreateWithName("module");
-    if (!module)
+    begin_phase(report, "codegen");
+    FunctionFingerprint *fingerprints = NULL;
+    int fingerprint_count = 0;
+    uint64_t function_key = 0;
+    if (cache)
     {
-        fprintf(stderr, "Error: Failed to create LLVM module.\n");
-        free(source);
-        exit(EXIT_FAILURE);
+        fingerprints = fingerprint_functions(ast, cache->config_hash, &fingerprint_count);
+        function_key = function_cache_key(cache, unit->path);
+        generate_from_function_cache(unit, ast, context, cache, function_key, fingerprints, fingerprint_count,
+                                     options->direct_ssa);
+        if (!unit->module)
+            cache->functions_generated += fingerprint_count;
+    }
+
+    // With -j, top-level functions are split into partitions that are
+    // generated, optimized and emitted on separate threads.
+    unit->parallel = !unit->module && options->jobs > 1 && count_top_level_statements(ast) > 1;
+    if (unit->parallel)
+    {
+        init_partitions(&unit->partitions, ast, options->jobs, options->direct_ssa, options->opt_level);
+        generate_partitions(&unit->partitions);
     }
+    else if (!unit->module)
+    {
+        unit->module = LLVMModuleCreateWithNameInContext("module", context);
+        if (!unit->module)
+        {
+            fprintf(stderr, "Error: Failed to create LLVM module.\n");
+            close_source_file(&source);
+            exit(EXIT_FAILURE);
+        }
 
-    LLVMTypeRef printf_type = LLVMFunctionType(
-        LLVMInt32Type(),
-        (LLVMTypeRef[]){LLVMPointerType(LLVMInt8Type(), 0)},
-        1,
-        1);
+        SymbolTable *sym_table = create_symbol_table();
+        CodeGen codegen;
+        init_codegen(&codegen, unit->module);
+        codegen.direct_ssa = options->direct_ssa;
+        declare_functions(&codegen, ast);
 
-    LLVMValueRef printf_func_llvm = LLVMAddFunction(module, "printf", printf_type);
-    if (!printf_func_llvm)
+        generate_code(ast, &codegen, sym_table, NULL);
+        order_functions(unit->module, ast);
+        dispose_codegen(&codegen);
+        free_symbol_table(sym_table);
+    }
+    end_phase(report);
+
+    if (cache)
     {
-        fprintf(stderr, "Error: Failed to declare printf function.\n");
-        LLVMDisposeModule(module);
-        free(source);
+        begin_phase(report, "cache");
+        store_unit(unit, cache, function_key, fingerprints, fingerprint_count);
+        free_function_fingerprints(fingerprints, fingerprint_count);
+        end_phase(report);
+    }
+
+    free_arena(&arena);
+    close_source_file(&source);
+
+    begin_phase(report, "optimize");
+    if (unit->parallel)
+    {
+        optimize_partitions(&unit->partitions);
+    }
+    else
+    {
+        configure_module_for_target(unit->module, target_machine);
+        optimize_module(unit->module, target_machine, options->opt_level, options->time_report == TIME_REPORT_TABLE);
+    }
+    end_phase(report);
+
+    if (cache)
+    {
+        begin_phase(report, "cache");
+        store_unit(unit, cache, cache_key, NULL, 0);
+        end_phase(report);
+    }
+}
+
+static int defines_function(LLVMModuleRef module, const char *name)
+{
+    LLVMValueRef func = LLVMGetNamedFunction(module, name);
+    return func && !LLVMIsDeclaration(func);
+}
+
+static int unit_defines_function(CompileUnit *unit, const char *name)
+{
+    if (!unit->parallel)
+        return defines_function(unit->module, name);
+
+    for (int i = 0; i < unit->partitions.partition_count; ++i)
+    {
+        if (defines_function(unit->partitions.partitions[i].module, name))
+            return 1;
+    }
+    return 0;
+}
+
+// Hands over the unit's code as a single module in `context`.
+static LLVMModuleRef take_unit_module(CompileUnit *unit, LLVMContextRef context)
+{
+    if (unit->parallel)
+    {
+        unit->module = link_partitions(&unit->partitions, context);
+        dispose_partitions(&unit->partitions);
+        unit->parallel = 0;
+    }
+
+    LLVMModuleRef module = unit->module;
+    unit->module = NULL;
+    return module;
+}
+
+// Links every unit into one module; calls between files resolve here, and
+// a function defined in more than one file is an error.
+static LLVMModuleRef link_units(CompileUnit *units, int unit_count, LLVMContextRef context)
+{
+    LLVMModuleRef linked = take_unit_module(&units[0], context);
+    for (int i = 1; i < unit_count; ++i)
+    {
+        if (LLVMLinkModules2(linked, take_unit_module(&units[i], context)))
+        {
+            fprintf(stderr, "Error: Failed to link %s.\n", units[i].path);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return linked;
+}
+
+static void link_units_executable(CompileUnit *units, CompilerOptions *options, LLVMTargetMachineRef target_machine)
+{
+    int object_count = 0;
+    for (int i = 0, unit_index = 0; i < options->input_count; ++i)
+    {
+        if (is_object_input(options->input_paths[i]))
+        {
+            object_count++;
+            continue;
+        }
+
+        CompileUnit *unit = &units[unit_index++];
+        object_count += unit->parallel ? unit->partitions.partition_count : 1;
+    }
+
+    const char **object_paths = malloc(sizeof(char *) * object_count);
+    char *temporary = malloc(object_count);
+    if (!object_paths || !temporary)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in link_units_executable.\n");
         exit(EXIT_FAILURE);
     }
 
-    LLVMValueRef format_str = LLVMAddGlobal(module, LLVMArrayType(LLVMInt8Type(), 4), "fmt");
-    LLVMSetInitializer(format_str, LLVMConstString("%d\n", 4, 1));
-    LLVMSetGlobalConstant(format_str, 1);
-    LLVMSetLinkage(format_str, LLVMPrivateLinkage);
+    // Objects are passed to the linker in command-line order.
+    int object = 0;
+    for (int i = 0, unit_index = 0; i < options->input_count; ++i)
+    {
+        if (is_object_input(options->input_paths[i]))
+        {
+            temporary[object] = 0;
+            object_paths[object++] = options->input_paths[i];
+            continue;
+        }
 
-    SymbolTable *sym_table = create_symbol_table();
+        CompileUnit *unit = &units[unit_index++];
+        if (unit->parallel)
+        {
+            const char **partition_paths = &object_paths[object];
+            for (int p = 0; p < unit->partitions.partition_count; ++p)
+            {
+                temporary[object] = 1;
+                object_paths[object++] = create_temporary_object_path();
+            }
+            emit_partition_objects(&unit->partitions, partition_paths);
+        }
+        else
+        {
+            temporary[object] = 1;
+            object_paths[object] = create_temporary_object_path();
+            emit_object_file(unit->module, target_machine, object_paths[object++]);
+        }
+    }
 
-    generate_code(ast, module, printf_func_llvm, format_str, sym_table, NULL);
+    // The temporaries are removed whether or not linking succeeded.
+    int status = link_executable(object_paths, object_count, options->output_path);
 
-    LLVMValueRef main_func = LLVMGetNamedFunction(module, "main");
-    if (!main_func)
+    for (int i = 0; i < object_count; ++i)
     {
-        fprintf(stderr, "Error: No 'main' function defined in syro code.\n");
-        LLVMDisposeModule(module);
-        free_ast(ast);
-        free_symbol_table(sym_table);
-        free(source);
+        if (!temporary[i])
+            continue;
+        unlink(object_paths[i]);
+        free((char *)object_paths[i]);
+    }
+    free(temporary);
+    free(object_paths);
+    if (status != 0)
+        exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    CompilerOptions options;
+    parse_options(argc, argv, &options);
+
+    TimeReport report;
+    init_time_report(&report, options.time_report);
+
+    LLVMContextRef context = LLVMContextCreate();
+    LLVMTargetMachineRef target_machine = create_host_target_machine(options.opt_level);
+
+    ModuleCache cache;
+    if (options.cache_dir)
+        init_module_cache(&cache, options.cache_dir, options.cache_max_bytes, target_machine, options.opt_level, options.direct_ssa);
+
+    int unit_count = 0;
+    CompileUnit *units = calloc(options.input_count, sizeof(CompileUnit));
+    if (!units)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in main.\n");
         exit(EXIT_FAILURE);
     }
 
-    char *llvm_ir = LLVMPrintModuleToString(module);
-    if (!llvm_ir)
+    for (int i = 0; i < options.input_count; ++i)
     {
-        fprintf(stderr, "Error: Failed to print LLVM IR.\n");
+        if (is_object_input(options.input_paths[i]))
+            continue;
+
+        CompileUnit *unit = &units[unit_count++];
+        unit->path = options.input_paths[i];
+        compile_unit(unit, context, target_machine, options.cache_dir ? &cache : NULL, &options, &report);
+    }
+
+    // An object file input may define main; the linker reports it otherwise.
+    int per_input = options.output_kind == OUTPUT_OBJECT || options.output_kind == OUTPUT_BITCODE;
+    if (!per_input && unit_count == options.input_count)
+    {
+        int has_main = 0;
+        for (int i = 0; i < unit_count && !has_main; ++i)
+            has_main = unit_defines_function(&units[i], "main");
+
+        if (!has_main)
+        {
+            fprintf(stderr, "Error: No 'main' function defined in syro code.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    begin_phase(&report, options.output_kind == OUTPUT_RUN ? "run" : "emit");
+    int exit_code = 0;
+    switch (options.output_kind)
+    {
+    case OUTPUT_IR:
+    {
+        LLVMModuleRef module = link_units(units, unit_count, context);
+        char *llvm_ir = LLVMPrintModuleToString(module);
+        if (!llvm_ir)
+        {
+            fprintf(stderr, "Error: Failed to print LLVM IR.\n");
+            exit(EXIT_FAILURE);
+        }
+        printf("%s", llvm_ir);
+        LLVMDisposeMessage(llvm_ir);
         LLVMDisposeModule(module);
-        free_ast(ast);
-        free_symbol_table(sym_table);
-        free(source);
-        exit(EXIT_FAILURE);
+        break;
+    }
+    case OUTPUT_OBJECT:
+        for (int i = 0; i < unit_count; ++i)
+        {
+            char *object_path = options.output_path ? strdup(options.output_path) : default_output_path(units[i].path, ".o");
+            LLVMModuleRef module = take_unit_module(&units[i], context);
+            emit_object_file(module, target_machine, object_path);
+            LLVMDisposeModule(module);
+            free(object_path);
+        }
+        break;
+    case OUTPUT_BITCODE:
+        for (int i = 0; i < unit_count; ++i)
+        {
+            char *bitcode_path = options.output_path ? strdup(options.output_path) : default_output_path(units[i].path, ".bc");
+            LLVMModuleRef module = take_unit_module(&units[i], context);
+            emit_bitcode_file(module, bitcode_path);
+            LLVMDisposeModule(module);
+            free(bitcode_path);
+        }
+        break;
+    case OUTPUT_EXECUTABLE:
+        link_units_executable(units, &options, target_machine);
+        break;
+    case OUTPUT_RUN:
+        exit_code = run_module(link_units(units, unit_count, context), options.opt_level);
+        break;
+    }
+    end_phase(&report);
+
+    if (options.cache_dir && cache.stores > 0)
+    {
+        begin_phase(&report, "cache");
+        module_cache_evict(&cache);
+        end_phase(&report);
+    }
+
+    for (int i = 0; i < unit_count; ++i)
+    {
+        if (units[i].parallel)
+            dispose_partitions(&units[i].partitions);
+        else if (units[i].module)
+            LLVMDisposeModule(units[i].module);
     }
-    printf("%s", llvm_ir);
-    LLVMDisposeMessage(llvm_ir);
+    free(units);
+    LLVMDisposeTargetMachine(target_machine);
+    LLVMContextDispose(context);
+    free_interned_strings();
+    free_types();
+    free_options(&options);
 
-    LLVMDisposeModule(module);
-    free_ast(ast);
-    free_symbol_table(sym_table);
-    free(source);
+    print_time_report(&report, stderr);
+    if (options.cache_dir && options.cache_stats)
+        print_cache_statistics(&cache, stderr);
 
-    return 0;
+    return exit_code;
 }
@@ -0,0 +1,129 @@
+// arena.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "error.h"
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT sizeof(void *)
+
+static size_t total_allocations = 0;
+static size_t total_bytes = 0;
+
+static ArenaChunk *new_chunk(Arena *arena, size_t minimum_size)
+{
+    size_t capacity = minimum_size > ARENA_CHUNK_SIZE ? minimum_size : ARENA_CHUNK_SIZE;
+    ArenaChunk *chunk = (ArenaChunk *)malloc(sizeof(ArenaChunk) + capacity);
+    if (!chunk)
+    {
+        error_report(-1, "Memory allocation failed in arena_alloc.\n");
+        exit(EXIT_FAILURE);
+    }
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena->chunk_count++;
+
+    // Oversized requests get a dedicated chunk behind the current one so the
+    // free space left in the head chunk is not abandoned.
+    if (minimum_size > ARENA_CHUNK_SIZE / 4 && arena->head)
+    {
+        chunk->next = arena->head->next;
+        arena->head->next = chunk;
+    }
+    else
+    {
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
+    return chunk;
+}
+
+void init_arena(Arena *arena)
+{
+    arena->head = NULL;
+    arena->bytes_allocated = 0;
+    arena->allocation_count = 0;
+    arena->chunk_count = 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+    ArenaChunk *chunk = arena->head;
+    if (!chunk || chunk->capacity - chunk->used < size)
+        chunk = new_chunk(arena, size);
+
+    void *memory = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->bytes_allocated += size;
+    arena->allocation_count++;
+    __atomic_fetch_add(&total_allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&total_bytes, size, __ATOMIC_RELAXED);
+    return memory;
+}
+
+void *arena_memdup(Arena *arena, const void *data, size_t size)
+{
+    if (size == 0)
+        return NULL;
+    void *copy = arena_alloc(arena, size);
+    memcpy(copy, data, size);
+    return copy;
+}
+
+char *arena_strndup(Arena *arena, const char *string, size_t length)
+{
+    char *copy = (char *)arena_alloc(arena, length + 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// Moves every chunk of `other` into `arena` and leaves `other` empty, so
+// nodes allocated on a worker thread live as long as the main arena.
+void arena_merge(Arena *arena, Arena *other)
+{
+    if (!other->head)
+        return;
+
+    ArenaChunk *last = other->head;
+    while (last->next)
+        last = last->next;
+
+    // The chunks go behind the current head, whose free space stays in use.
+    if (arena->head)
+    {
+        last->next = arena->head->next;
+        arena->head->next = other->head;
+    }
+    else
+    {
+        arena->head = other->head;
+    }
+
+    arena->bytes_allocated += other->bytes_allocated;
+    arena->allocation_count += other->allocation_count;
+    arena->chunk_count += other->chunk_count;
+    init_arena(other);
+}
+
+void free_arena(Arena *arena)
+{
+    ArenaChunk *chunk = arena->head;
+    while (chunk)
+    {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    init_arena(arena);
+}
+
+void arena_statistics(size_t *allocations, size_t *bytes)
+{
+    *allocations = __atomic_load_n(&total_allocations, __ATOMIC_RELAXED);
+    *bytes = __atomic_load_n(&total_bytes, __ATOMIC_RELAXED);
+}
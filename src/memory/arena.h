@@ -0,0 +1,34 @@
+// arena.h
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct ArenaChunk ArenaChunk;
+
+struct ArenaChunk
+{
+    ArenaChunk *next;
+    size_t capacity;
+    size_t used;
+    char data[];
+};
+
+typedef struct
+{
+    ArenaChunk *head;
+    size_t bytes_allocated;
+    size_t allocation_count;
+    size_t chunk_count;
+} Arena;
+
+void init_arena(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+void *arena_memdup(Arena *arena, const void *data, size_t size);
+char *arena_strndup(Arena *arena, const char *string, size_t length);
+void arena_merge(Arena *arena, Arena *other);
+void free_arena(Arena *arena);
+void arena_statistics(size_t *allocations, size_t *bytes);
+
+#endif // ARENA_H
@@ -0,0 +1,489 @@
+// fold.c
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <error.h>
+#include "fold.h"
+
+// Integer literals are i32 and codegen lowers them with wrapping LLVM
+// arithmetic, so folding is done on uint32_t to get the same results.
+
+// The fold tracks the names visible at each point, scoped the way codegen
+// scopes them. A subtree is only dropped when every name it uses resolves,
+// so an undefined name in a dead branch or in the x of x*0 is still
+// reported by codegen. Names are interned and compared by pointer.
+
+typedef enum
+{
+    NAME_VARIABLE,
+    NAME_ARRAY,
+    NAME_FUNCTION,
+} NameKind;
+
+typedef struct
+{
+    char *name;
+    NameKind kind;
+    int param_count;
+} ScopedName;
+
+typedef struct
+{
+    Arena *arena;
+    ScopedName *names;
+    int count;
+    int capacity;
+} FoldContext;
+
+static void declare_name(FoldContext *context, char *name, NameKind kind, int param_count)
+{
+    if (context->count == context->capacity)
+    {
+        context->capacity = context->capacity ? context->capacity * 2 : 64;
+        context->names = realloc(context->names, sizeof(ScopedName) * context->capacity);
+        if (!context->names)
+        {
+            error_report(-1, "Memory allocation failed in declare_name.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    context->names[context->count++] = (ScopedName){name, kind, param_count};
+}
+
+// Returns the innermost declaration of `name`. Functions and variables
+// live in separate namespaces, as they do in codegen.
+static ScopedName *find_name(FoldContext *context, char *name, int function)
+{
+    for (int i = context->count - 1; i >= 0; --i)
+    {
+        ScopedName *entry = &context->names[i];
+        if (entry->name == name && (entry->kind == NAME_FUNCTION) == function)
+            return entry;
+    }
+    return NULL;
+}
+
+static int names_resolve(FoldContext *context, Node *node);
+
+static int names_resolve_scoped(FoldContext *context, Node *node)
+{
+    int mark = context->count;
+    int resolved = names_resolve(context, node);
+    context->count = mark;
+    return resolved;
+}
+
+// Returns whether codegen would resolve every name under `node`.
+// Declarations inside the subtree are visible to the statements after them.
+static int names_resolve(FoldContext *context, Node *node)
+{
+    if (!node)
+        return 1;
+
+    switch (node->type)
+    {
+    case AST_NUMBER:
+        return 1;
+    case AST_IDENTIFIER:
+        return find_name(context, node->as.name, 0) != NULL;
+    case AST_ADDRESS_OF:
+        return node->as.operand->type == AST_IDENTIFIER && names_resolve(context, node->as.operand);
+    case AST_NEGATE:
+    case AST_DEREFERENCE:
+    case AST_PRINT:
+    case AST_RETURN_STMT:
+        return names_resolve(context, node->as.operand);
+    case AST_BLOCK:
+        return names_resolve_scoped(context, node->as.operand);
+    case AST_PLUS:
+    case AST_MINUS:
+    case AST_STAR:
+    case AST_SLASH:
+    case AST_SHIFT_LEFT:
+    case AST_EQUAL_EQUAL:
+    case AST_BANG_EQUAL:
+    case AST_LESS:
+    case AST_LESS_EQUAL:
+    case AST_GREATER:
+    case AST_GREATER_EQUAL:
+        return names_resolve(context, node->as.binary.left) && names_resolve(context, node->as.binary.right);
+    case AST_ASSIGNMENT:
+        return find_name(context, node->as.assignment.name, 0) != NULL &&
+               names_resolve(context, node->as.assignment.value);
+    case AST_DEREFERENCE_ASSIGNMENT:
+        return names_resolve(context, node->as.dereference_assignment.target) &&
+               names_resolve(context, node->as.dereference_assignment.value);
+    case AST_VARIABLE_DECL:
+        if (!names_resolve(context, node->as.variable_decl.initializer))
+            return 0;
+        declare_name(context, node->as.variable_decl.name, NAME_VARIABLE, 0);
+        return 1;
+    case AST_ARRAY_DECL:
+        for (int i = 0; i < node->as.array_decl.element_count; i++)
+        {
+            if (!names_resolve(context, node->as.array_decl.elements[i]))
+                return 0;
+        }
+        declare_name(context, node->as.array_decl.name, NAME_ARRAY, 0);
+        return 1;
+    case AST_ARRAY_ACCESS:
+    {
+        ScopedName *array = find_name(context, node->as.array_access.name, 0);
+        return array && array->kind == NAME_ARRAY && names_resolve(context, node->as.array_access.index);
+    }
+    case AST_ARRAY_ASSIGNMENT:
+    {
+        ScopedName *array = find_name(context, node->as.array_assignment.name, 0);
+        return array && array->kind == NAME_ARRAY && names_resolve(context, node->as.array_assignment.index) &&
+               names_resolve(context, node->as.array_assignment.value);
+    }
+    case AST_FUNCTION_CALL:
+    {
+        ScopedName *function = find_name(context, node->as.function_call.name, 1);
+        if (!function || function->param_count != node->as.function_call.arg_count)
+            return 0;
+        for (int i = 0; i < node->as.function_call.arg_count; i++)
+        {
+            if (!names_resolve(context, node->as.function_call.arguments[i]))
+                return 0;
+        }
+        return 1;
+    }
+    case AST_STATEMENT_LIST:
+        for (Node *entry = node; entry != NULL; entry = entry->as.statement_list.next)
+        {
+            if (!names_resolve(context, entry->as.statement_list.statement))
+                return 0;
+        }
+        return 1;
+    case AST_CAST:
+        return names_resolve(context, node->as.cast.expression);
+    case AST_IF_STATEMENT:
+        return names_resolve(context, node->as.if_statement.condition) &&
+               names_resolve_scoped(context, node->as.if_statement.then_branch) &&
+               names_resolve_scoped(context, node->as.if_statement.else_branch);
+    case AST_WHILE_STATEMENT:
+        return names_resolve(context, node->as.while_statement.condition) &&
+               names_resolve_scoped(context, node->as.while_statement.body);
+    case AST_FOR_STATEMENT:
+        // The init declares into the enclosing scope, as in codegen.
+        return names_resolve(context, node->as.for_statement.init) &&
+               names_resolve(context, node->as.for_statement.condition) &&
+               names_resolve(context, node->as.for_statement.increment) &&
+               names_resolve_scoped(context, node->as.for_statement.body);
+    default:
+        return 0;
+    }
+}
+
+static int is_number(Node *node, int value)
+{
+    return node->type == AST_NUMBER && node->as.number == value;
+}
+
+static int power_of_two_exponent(Node *node)
+{
+    if (node->type != AST_NUMBER || node->as.number <= 0)
+        return -1;
+
+    unsigned int value = (unsigned int)node->as.number;
+    if ((value & (value - 1)) != 0)
+        return -1;
+
+    return __builtin_ctz(value);
+}
+
+static int has_side_effects(Node *node)
+{
+    switch (node->type)
+    {
+    case AST_NUMBER:
+    case AST_IDENTIFIER:
+        return 0;
+    case AST_NEGATE:
+    case AST_DEREFERENCE:
+        return has_side_effects(node->as.operand);
+    case AST_CAST:
+        return has_side_effects(node->as.cast.expression);
+    case AST_ARRAY_ACCESS:
+        return has_side_effects(node->as.array_access.index);
+    case AST_SLASH:
+        // A division that may trap has to stay even when its result is unused.
+        if (node->as.binary.right->type != AST_NUMBER || node->as.binary.right->as.number == 0 ||
+            node->as.binary.right->as.number == -1)
+            return 1;
+        return has_side_effects(node->as.binary.left);
+    case AST_PLUS:
+    case AST_MINUS:
+    case AST_STAR:
+    case AST_SHIFT_LEFT:
+    case AST_EQUAL_EQUAL:
+    case AST_BANG_EQUAL:
+    case AST_LESS:
+    case AST_LESS_EQUAL:
+    case AST_GREATER:
+    case AST_GREATER_EQUAL:
+        return has_side_effects(node->as.binary.left) || has_side_effects(node->as.binary.right);
+    default:
+        return 1;
+    }
+}
+
+static int fold_binary_numbers(NodeType type, int left, int right, int *result)
+{
+    uint32_t a = (uint32_t)left;
+    uint32_t b = (uint32_t)right;
+
+    switch (type)
+    {
+    case AST_PLUS:
+        *result = (int32_t)(a + b);
+        return 1;
+    case AST_MINUS:
+        *result = (int32_t)(a - b);
+        return 1;
+    case AST_STAR:
+        *result = (int32_t)(a * b);
+        return 1;
+    case AST_SLASH:
+        // Leave undefined divisions for the program to hit at runtime.
+        if (right == 0 || (left == INT_MIN && right == -1))
+            return 0;
+        *result = left / right;
+        return 1;
+    case AST_SHIFT_LEFT:
+        if (right < 0 || right > 31)
+            return 0;
+        *result = (int32_t)(a << right);
+        return 1;
+    case AST_EQUAL_EQUAL:
+        *result = left == right;
+        return 1;
+    case AST_BANG_EQUAL:
+        *result = left != right;
+        return 1;
+    case AST_LESS:
+        *result = left < right;
+        return 1;
+    case AST_LESS_EQUAL:
+        *result = left <= right;
+        return 1;
+    case AST_GREATER:
+        *result = left > right;
+        return 1;
+    case AST_GREATER_EQUAL:
+        *result = left >= right;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static Node *fold_node(FoldContext *context, Node *node);
+
+static Node *fold_binary(FoldContext *context, Node *node)
+{
+    Arena *arena = context->arena;
+    Node *left = fold_node(context, node->as.binary.left);
+    Node *right = fold_node(context, node->as.binary.right);
+    node->as.binary.left = left;
+    node->as.binary.right = right;
+
+    int value;
+    if (left->type == AST_NUMBER && right->type == AST_NUMBER &&
+        fold_binary_numbers(node->type, left->as.number, right->as.number, &value))
+    {
+        return make_number(arena, value);
+    }
+
+    switch (node->type)
+    {
+    case AST_PLUS:
+        if (is_number(right, 0))
+            return left;
+        if (is_number(left, 0))
+            return right;
+        break;
+    case AST_MINUS:
+        if (is_number(right, 0))
+            return left;
+        break;
+    case AST_STAR:
+    {
+        if (is_number(right, 1))
+            return left;
+        if (is_number(left, 1))
+            return right;
+        if ((is_number(right, 0) && !has_side_effects(left) && names_resolve_scoped(context, left)) ||
+            (is_number(left, 0) && !has_side_effects(right) && names_resolve_scoped(context, right)))
+        {
+            return make_number(arena, 0);
+        }
+
+        int shift = power_of_two_exponent(right);
+        if (shift > 0)
+            return make_binary(arena, AST_SHIFT_LEFT, left, make_number(arena, shift));
+
+        shift = power_of_two_exponent(left);
+        if (shift > 0)
+            return make_binary(arena, AST_SHIFT_LEFT, right, make_number(arena, shift));
+        break;
+    }
+    case AST_SLASH:
+        if (is_number(right, 1))
+            return left;
+        break;
+    default:
+        break;
+    }
+
+    return node;
+}
+
+static Node *fold_scoped(FoldContext *context, Node *node)
+{
+    int mark = context->count;
+    node = fold_node(context, node);
+    context->count = mark;
+    return node;
+}
+
+static Node *fold_if_statement(FoldContext *context, Node *node)
+{
+    Node *condition = fold_node(context, node->as.if_statement.condition);
+    Node *then_branch = fold_scoped(context, node->as.if_statement.then_branch);
+    Node *else_branch = fold_scoped(context, node->as.if_statement.else_branch);
+
+    if (condition->type == AST_NUMBER)
+    {
+        Node *taken = condition->as.number != 0 ? then_branch : else_branch;
+        Node *dead = condition->as.number != 0 ? else_branch : then_branch;
+
+        // The surviving branch keeps its own scope, so its declarations
+        // cannot clash with the enclosing ones.
+        if (names_resolve_scoped(context, dead))
+            return make_block(context->arena, taken);
+    }
+
+    node->as.if_statement.condition = condition;
+    node->as.if_statement.then_branch = then_branch;
+    node->as.if_statement.else_branch = else_branch;
+    return node;
+}
+
+static Node *fold_node(FoldContext *context, Node *node)
+{
+    if (!node)
+        return NULL;
+
+    switch (node->type)
+    {
+    case AST_PLUS:
+    case AST_MINUS:
+    case AST_STAR:
+    case AST_SLASH:
+    case AST_SHIFT_LEFT:
+    case AST_EQUAL_EQUAL:
+    case AST_BANG_EQUAL:
+    case AST_LESS:
+    case AST_LESS_EQUAL:
+    case AST_GREATER:
+    case AST_GREATER_EQUAL:
+        return fold_binary(context, node);
+    case AST_NEGATE:
+    {
+        Node *operand = fold_node(context, node->as.operand);
+        if (operand->type == AST_NUMBER)
+            return make_number(context->arena, (int32_t)(0u - (uint32_t)operand->as.number));
+        node->as.operand = operand;
+        return node;
+    }
+    case AST_ADDRESS_OF:
+    case AST_DEREFERENCE:
+    case AST_PRINT:
+    case AST_RETURN_STMT:
+        node->as.operand = fold_node(context, node->as.operand);
+        return node;
+    case AST_BLOCK:
+        node->as.operand = fold_scoped(context, node->as.operand);
+        return node;
+    case AST_ASSIGNMENT:
+        node->as.assignment.value = fold_node(context, node->as.assignment.value);
+        return node;
+    case AST_DEREFERENCE_ASSIGNMENT:
+        node->as.dereference_assignment.target = fold_node(context, node->as.dereference_assignment.target);
+        node->as.dereference_assignment.value = fold_node(context, node->as.dereference_assignment.value);
+        return node;
+    case AST_VARIABLE_DECL:
+        node->as.variable_decl.initializer = fold_node(context, node->as.variable_decl.initializer);
+        declare_name(context, node->as.variable_decl.name, NAME_VARIABLE, 0);
+        return node;
+    case AST_ARRAY_DECL:
+        for (int i = 0; i < node->as.array_decl.element_count; i++)
+            node->as.array_decl.elements[i] = fold_node(context, node->as.array_decl.elements[i]);
+        declare_name(context, node->as.array_decl.name, NAME_ARRAY, 0);
+        return node;
+    case AST_ARRAY_ACCESS:
+        node->as.array_access.index = fold_node(context, node->as.array_access.index);
+        return node;
+    case AST_ARRAY_ASSIGNMENT:
+        node->as.array_assignment.index = fold_node(context, node->as.array_assignment.index);
+        node->as.array_assignment.value = fold_node(context, node->as.array_assignment.value);
+        return node;
+    case AST_FUNCTION_DECL:
+    {
+        int mark = context->count;
+        for (int i = 0; i < node->as.function_decl.param_count; i++)
+            declare_name(context, node->as.function_decl.parameters[i]->as.variable_decl.name, NAME_VARIABLE, 0);
+        node->as.function_decl.body = fold_node(context, node->as.function_decl.body);
+        context->count = mark;
+        return node;
+    }
+    case AST_FUNCTION_CALL:
+        for (int i = 0; i < node->as.function_call.arg_count; i++)
+            node->as.function_call.arguments[i] = fold_node(context, node->as.function_call.arguments[i]);
+        return node;
+    case AST_STATEMENT_LIST:
+        for (Node *entry = node; entry != NULL; entry = entry->as.statement_list.next)
+            entry->as.statement_list.statement = fold_node(context, entry->as.statement_list.statement);
+        return node;
+    case AST_CAST:
+        node->as.cast.expression = fold_node(context, node->as.cast.expression);
+        return node;
+    case AST_IF_STATEMENT:
+        return fold_if_statement(context, node);
+    case AST_WHILE_STATEMENT:
+        node->as.while_statement.condition = fold_node(context, node->as.while_statement.condition);
+        node->as.while_statement.body = fold_scoped(context, node->as.while_statement.body);
+        return node;
+    case AST_FOR_STATEMENT:
+        node->as.for_statement.init = fold_node(context, node->as.for_statement.init);
+        node->as.for_statement.condition = fold_node(context, node->as.for_statement.condition);
+        node->as.for_statement.increment = fold_node(context, node->as.for_statement.increment);
+        node->as.for_statement.body = fold_scoped(context, node->as.for_statement.body);
+        return node;
+    default:
+        return node;
+    }
+}
+
+Node *fold_constants(Arena *arena, Node *node)
+{
+    FoldContext context = {arena, NULL, 0, 0};
+
+    // Every top-level function is callable from anywhere in the file.
+    if (node && node->type == AST_STATEMENT_LIST)
+    {
+        for (Node *entry = node; entry != NULL; entry = entry->as.statement_list.next)
+        {
+            Node *statement = entry->as.statement_list.statement;
+            if (statement && statement->type == AST_FUNCTION_DECL)
+                declare_name(&context, statement->as.function_decl.name, NAME_FUNCTION, statement->as.function_decl.param_count);
+        }
+    }
+
+    node = fold_node(&context, node);
+    free(context.names);
+    return node;
+}
@@ -0,0 +1,11 @@
+// fold.h
+
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <parser/ast.h>
+#include <memory/arena.h>
+
+Node *fold_constants(Arena *arena, Node *node);
+
+#endif // FOLD_H
@@ -0,0 +1,57 @@
+// optimizer.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <llvm-c/Analysis.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/Support.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+#include "optimizer.h"
+
+void optimize_module(LLVMModuleRef module, LLVMTargetMachineRef target_machine, int opt_level, int time_passes)
+{
+    char *message = NULL;
+    if (LLVMVerifyModule(module, LLVMReturnStatusAction, &message))
+    {
+        fprintf(stderr, "Error: Generated module is invalid:\n%s", message);
+        LLVMDisposeMessage(message);
+        exit(EXIT_FAILURE);
+    }
+    LLVMDisposeMessage(message);
+
+    if (opt_level <= 0)
+        return;
+
+    // The default<On> pipelines cover mem2reg/SROA, instcombine, GVN, the loop
+    // passes, inlining and both vectorizers; the target machine supplies the
+    // cost model the vectorizers and unroller rely on.
+    const char *pipelines[] = {"default<O0>", "default<O1>", "default<O2>", "default<O3>"};
+    if (opt_level > 3)
+        opt_level = 3;
+
+    if (time_passes)
+    {
+        // LLVM prints its per-pass timing table to stderr when the pipeline
+        // finishes.
+        const char *args[] = {"syroc", "-time-passes"};
+        LLVMParseCommandLineOptions(2, args, NULL);
+    }
+
+    LLVMPassBuilderOptionsRef pass_options = LLVMCreatePassBuilderOptions();
+    LLVMPassBuilderOptionsSetLoopInterleaving(pass_options, opt_level >= 2);
+    LLVMPassBuilderOptionsSetLoopVectorization(pass_options, opt_level >= 2);
+    LLVMPassBuilderOptionsSetSLPVectorization(pass_options, opt_level >= 2);
+    LLVMPassBuilderOptionsSetLoopUnrolling(pass_options, opt_level >= 2);
+    LLVMPassBuilderOptionsSetMergeFunctions(pass_options, opt_level >= 3);
+
+    LLVMErrorRef error = LLVMRunPasses(module, pipelines[opt_level], target_machine, pass_options);
+    LLVMDisposePassBuilderOptions(pass_options);
+
+    if (error)
+    {
+        char *error_message = LLVMGetErrorMessage(error);
+        fprintf(stderr, "Error: Optimization pipeline failed: %s\n", error_message);
+        LLVMDisposeErrorMessage(error_message);
+        exit(EXIT_FAILURE);
+    }
+}
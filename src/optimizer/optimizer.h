@@ -0,0 +1,11 @@
+// optimizer.h
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+
+void optimize_module(LLVMModuleRef module, LLVMTargetMachineRef target_machine, int opt_level, int time_passes);
+
+#endif // OPTIMIZER_H
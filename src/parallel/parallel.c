@@ -0,0 +1,67 @@
+// parallel.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parallel.h"
+
+typedef struct
+{
+    void (*task)(void *context, int index);
+    void *context;
+    int index;
+} TaskArgs;
+
+static void *run_task(void *argument)
+{
+    TaskArgs *args = (TaskArgs *)argument;
+    args->task(args->context, args->index);
+    return NULL;
+}
+
+int hardware_thread_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+void parallel_for(int count, void (*task)(void *context, int index), void *context)
+{
+    if (count <= 0)
+        return;
+
+    TaskArgs *args = malloc(sizeof(TaskArgs) * count);
+    pthread_t *threads = malloc(sizeof(pthread_t) * count);
+    int *started = calloc(count, sizeof(int));
+    if (!args || !threads || !started)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in parallel_for.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        args[i].task = task;
+        args[i].context = context;
+        args[i].index = i;
+    }
+
+    // The calling thread takes index 0; a task whose thread cannot be
+    // started runs inline instead.
+    for (int i = 1; i < count; ++i)
+        started[i] = pthread_create(&threads[i], NULL, run_task, &args[i]) == 0;
+
+    task(context, 0);
+    for (int i = 1; i < count; ++i)
+    {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            task(context, i);
+    }
+
+    free(started);
+    free(threads);
+    free(args);
+}
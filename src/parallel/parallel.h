@@ -0,0 +1,12 @@
+// parallel.h
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+int hardware_thread_count(void);
+
+// Runs task(context, i) for every i in [0, count), one thread per index.
+// Returns once all tasks have finished.
+void parallel_for(int count, void (*task)(void *context, int index), void *context);
+
+#endif // PARALLEL_H
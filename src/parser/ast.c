@@ -3,217 +3,223 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include "error.h"
 #include "ast.h"
 
-Node *make_node(NodeType type, Node *left, Node *right, int number_value)
+// Nodes are allocated with only the header plus the payload their kind uses,
+// so a number leaf costs a fraction of a function declaration.
+#define NODE_SIZE(payload) (offsetof(Node, as) + sizeof(((Node *)0)->as.payload))
+
+static Node *make_node(Arena *arena, NodeType type, size_t size)
 {
-    Node *node = (Node *)malloc(sizeof(Node));
-    if (node == NULL)
-    {
-        error_report(-1, "Memory allocation failed in make_node.\n");
-        exit(EXIT_FAILURE);
-    }
+    Node *node = (Node *)arena_alloc(arena, size);
     node->type = type;
-    node->left = left;
-    node->right = right;
-    node->number_value = number_value;
-    node->var_type = NULL;
-    node->var_name = NULL;
-    node->expression = NULL;
-    node->func_name = NULL;
-    node->parameters = NULL;
-    node->param_count = 0;
-    node->body = NULL;
-    node->return_type = NULL;
-    node->cast_type = NULL;
-    node->condition = NULL;
-    node->then_branch = NULL;
-    node->else_branch = NULL;
-    node->init = NULL;
-    node->increment = NULL;
+    return node;
+}
 
+Node *make_binary(Arena *arena, NodeType type, Node *left, Node *right)
+{
+    Node *node = make_node(arena, type, NODE_SIZE(binary));
+    node->as.binary.left = left;
+    node->as.binary.right = right;
     return node;
 }
 
-Node *make_leaf(NodeType type, int number_value)
+Node *make_number(Arena *arena, int value)
 {
-    return make_node(type, NULL, NULL, number_value);
+    Node *node = make_node(arena, AST_NUMBER, NODE_SIZE(number));
+    node->as.number = value;
+    return node;
 }
 
-Node *make_assignment(char *var_name, Node *expression)
+Node *make_negate(Arena *arena, Node *operand)
 {
-    Node *node = make_node(AST_ASSIGNMENT, NULL, NULL, 0);
-    node->var_name = var_name;
-    node->expression = expression;
+    Node *node = make_node(arena, AST_NEGATE, NODE_SIZE(operand));
+    node->as.operand = operand;
     return node;
 }
 
-Node *make_dereference_assignment(Node *dereferenced_expr, Node *value_expr)
+Node *make_assignment(Arena *arena, char *var_name, Node *expression)
 {
-    Node *node = make_node(AST_DEREFERENCE_ASSIGNMENT, dereferenced_expr, value_expr, 0);
+    Node *node = make_node(arena, AST_ASSIGNMENT, NODE_SIZE(assignment));
+    node->as.assignment.name = var_name;
+    node->as.assignment.value = expression;
     return node;
 }
 
-Node *make_array_type(char *element_type, int size)
+Node *make_dereference_assignment(Arena *arena, Node *dereferenced_expr, Node *value_expr)
 {
-    Node *node = make_node(AST_ARRAY_TYPE, NULL, NULL, 0);
-    node->var_type = element_type;
-    node->number_value = size;
+    Node *node = make_node(arena, AST_DEREFERENCE_ASSIGNMENT, NODE_SIZE(dereference_assignment));
+    node->as.dereference_assignment.target = dereferenced_expr;
+    node->as.dereference_assignment.value = value_expr;
     return node;
 }
 
-Node *make_array_decl(char *var_name, Node *array_type, Node **elements, int element_count)
+Node *make_array_decl(Arena *arena, char *var_name, Type *element_type, int length, Node **elements, int element_count)
 {
-    Node *node = make_node(AST_ARRAY_DECL, NULL, NULL, 0);
-    node->var_name = var_name;
-    node->var_type = array_type->var_type;
-    node->number_value = array_type->number_value;
-    node->parameters = elements;
-    node->param_count = element_count;
+    Node *node = make_node(arena, AST_ARRAY_DECL, NODE_SIZE(array_decl));
+    node->as.array_decl.name = var_name;
+    node->as.array_decl.element_type = element_type;
+    node->as.array_decl.length = length;
+    node->as.array_decl.elements = elements;
+    node->as.array_decl.element_count = element_count;
     return node;
 }
 
-Node *make_array_access(char *var_name, Node *index)
+Node *make_array_access(Arena *arena, char *var_name, Node *index)
 {
-    Node *node = make_node(AST_ARRAY_ACCESS, NULL, NULL, 0);
-    node->var_name = var_name;
-    node->expression = index;
+    Node *node = make_node(arena, AST_ARRAY_ACCESS, NODE_SIZE(array_access));
+    node->as.array_access.name = var_name;
+    node->as.array_access.index = index;
     return node;
 }
 
-Node *make_array_assignment(char *array_name, Node *index, Node *value)
+Node *make_array_assignment(Arena *arena, char *array_name, Node *index, Node *value)
 {
-    Node *node = make_node(AST_ARRAY_ASSIGNMENT, NULL, NULL, 0);
-    node->var_name = array_name;
-    node->left = index;
-    node->right = value;
+    Node *node = make_node(arena, AST_ARRAY_ASSIGNMENT, NODE_SIZE(array_assignment));
+    node->as.array_assignment.name = array_name;
+    node->as.array_assignment.index = index;
+    node->as.array_assignment.value = value;
     return node;
 }
 
-Node *make_function_decl(char *func_name, Node **parameters, int param_count, char *return_type, Node *body)
+Node *make_function_decl(Arena *arena, char *func_name, Node **parameters, int param_count, Type *return_type, Node *body)
 {
-    Node *node = make_node(AST_FUNCTION_DECL, NULL, NULL, 0);
-    node->func_name = func_name;
-    node->parameters = parameters;
-    node->param_count = param_count;
-    node->return_type = return_type;
-    node->body = body;
+    Node *node = make_node(arena, AST_FUNCTION_DECL, NODE_SIZE(function_decl));
+    node->as.function_decl.name = func_name;
+    node->as.function_decl.parameters = parameters;
+    node->as.function_decl.param_count = param_count;
+    node->as.function_decl.return_type = return_type;
+    node->as.function_decl.body = body;
+    node->as.function_decl.is_prototype = 0;
     return node;
 }
 
-Node *make_variable_decl(char *var_type, char *var_name, Node *expression)
+Node *make_variable_decl(Arena *arena, Type *var_type, char *var_name, Node *expression)
 {
-    Node *node = make_node(AST_VARIABLE_DECL, NULL, NULL, 0);
-    node->var_type = var_type;
-    node->var_name = var_name;
-    node->expression = expression;
+    Node *node = make_node(arena, AST_VARIABLE_DECL, NODE_SIZE(variable_decl));
+    node->as.variable_decl.type = var_type;
+    node->as.variable_decl.name = var_name;
+    node->as.variable_decl.initializer = expression;
     return node;
 }
 
-Node *make_return_stmt(Node *expression)
+Node *make_return_stmt(Arena *arena, Node *expression)
 {
-    Node *node = make_node(AST_RETURN_STMT, NULL, NULL, 0);
-    node->expression = expression;
+    Node *node = make_node(arena, AST_RETURN_STMT, NODE_SIZE(operand));
+    node->as.operand = expression;
     return node;
 }
 
-Node *make_print(Node *expression)
+Node *make_print(Arena *arena, Node *expression)
 {
-    Node *node = make_node(AST_PRINT, NULL, NULL, 0);
-    node->expression = expression;
+    Node *node = make_node(arena, AST_PRINT, NODE_SIZE(operand));
+    node->as.operand = expression;
     return node;
 }
 
-Node *make_variable_ref(char *var_name)
+Node *make_variable_ref(Arena *arena, char *var_name)
 {
-    Node *node = make_node(AST_IDENTIFIER, NULL, NULL, 0);
-    node->var_name = var_name;
+    Node *node = make_node(arena, AST_IDENTIFIER, NODE_SIZE(name));
+    node->as.name = var_name;
     return node;
 }
 
-Node *make_function_call(char *func_name, Node **arguments, int arg_count)
+Node *make_function_call(Arena *arena, char *func_name, Node **arguments, int arg_count)
 {
-    Node *node = make_node(AST_FUNCTION_CALL, NULL, NULL, 0);
-    node->func_name = func_name;
-    node->parameters = arguments;
-    node->param_count = arg_count;
+    Node *node = make_node(arena, AST_FUNCTION_CALL, NODE_SIZE(function_call));
+    node->as.function_call.name = func_name;
+    node->as.function_call.arguments = arguments;
+    node->as.function_call.arg_count = arg_count;
     return node;
 }
 
-Node *make_statement_list(Node *list, Node *statement)
+Node *make_statement_list(Arena *arena, Node *tail, Node *statement)
 {
-    if (list == NULL)
-        return make_node(AST_STATEMENT_LIST, statement, NULL, 0);
-    Node *current = list;
-    while (current->right != NULL && current->type == AST_STATEMENT_LIST)
-        current = current->right;
-    Node *new_list = make_node(AST_STATEMENT_LIST, statement, NULL, 0);
-    current->right = new_list;
-    return list;
+    Node *entry = make_node(arena, AST_STATEMENT_LIST, NODE_SIZE(statement_list));
+    entry->as.statement_list.statement = statement;
+    entry->as.statement_list.next = NULL;
+    if (tail != NULL)
+        tail->as.statement_list.next = entry;
+    return entry;
+}
+
+Node *make_cast(Arena *arena, Type *cast_type, Node *expression)
+{
+    Node *node = make_node(arena, AST_CAST, NODE_SIZE(cast));
+    node->as.cast.type = cast_type;
+    node->as.cast.expression = expression;
+    return node;
 }
 
-Node *make_cast(char *cast_type, Node *expression)
+Node *make_if_statement(Arena *arena, Node *condition, Node *then_branch, Node *else_branch)
 {
-    Node *node = make_node(AST_CAST, NULL, NULL, 0);
-    node->cast_type = cast_type;
-    node->expression = expression;
+    Node *node = make_node(arena, AST_IF_STATEMENT, NODE_SIZE(if_statement));
+    node->as.if_statement.condition = condition;
+    node->as.if_statement.then_branch = then_branch;
+    node->as.if_statement.else_branch = else_branch;
     return node;
 }
 
-Node *make_if_statement(Node *condition, Node *then_branch, Node *else_branch)
+Node *make_while_statement(Arena *arena, Node *condition, Node *body)
 {
-    Node *node = make_node(AST_IF_STATEMENT, NULL, NULL, 0);
-    node->condition = condition;
-    node->then_branch = then_branch;
-    node->else_branch = else_branch;
+    Node *node = make_node(arena, AST_WHILE_STATEMENT, NODE_SIZE(while_statement));
+    node->as.while_statement.condition = condition;
+    node->as.while_statement.body = body;
     return node;
 }
 
-Node *make_while_statement(Node *condition, Node *body)
+Node *make_for_statement(Arena *arena, Node *init, Node *condition, Node *increment, Node *body)
 {
-    Node *node = make_node(AST_WHILE_STATEMENT, NULL, NULL, 0);
-    node->condition = condition;
-    node->body = body;
+    Node *node = make_node(arena, AST_FOR_STATEMENT, NODE_SIZE(for_statement));
+    node->as.for_statement.init = init;
+    node->as.for_statement.condition = condition;
+    node->as.for_statement.increment = increment;
+    node->as.for_statement.body = body;
     return node;
 }
 
-Node *make_for_statement(Node *init, Node *condition, Node *increment, Node *body)
+Node *make_address_of(Arena *arena, Node *expression)
 {
-    Node *node = make_node(AST_FOR_STATEMENT, NULL, NULL, 0);
-    node->init = init;
-    node->condition = condition;
-    node->increment = increment;
-    node->body = body;
+    Node *node = make_node(arena, AST_ADDRESS_OF, NODE_SIZE(operand));
+    node->as.operand = expression;
     return node;
 }
 
-Node *make_address_of(Node *expression)
+Node *make_dereference(Arena *arena, Node *expression)
 {
-    Node *node = make_node(AST_ADDRESS_OF, NULL, NULL, 0);
-    node->expression = expression;
+    Node *node = make_node(arena, AST_DEREFERENCE, NODE_SIZE(operand));
+    node->as.operand = expression;
     return node;
 }
 
-Node *make_dereference(Node *expression)
+Node *make_block(Arena *arena, Node *statements)
 {
-    Node *node = make_node(AST_DEREFERENCE, NULL, NULL, 0);
-    node->expression = expression;
+    Node *node = make_node(arena, AST_BLOCK, NODE_SIZE(operand));
+    node->as.operand = statements;
     return node;
 }
 
+static Node **move_nodes_to_arena(Arena *arena, Node **nodes, int count)
+{
+    Node **arena_nodes = (Node **)arena_memdup(arena, nodes, sizeof(Node *) * count);
+    free(nodes);
+    return arena_nodes;
+}
+
 Node *parse_expression_statement(Lexer *lexer)
 {
     if (lexer->current_token.type == TOKEN_IDENTIFIER)
     {
-        char *identifier = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+        char *identifier = lexer->current_token.name;
         scan_token(lexer);
 
         if (lexer->current_token.type == TOKEN_EQUAL)
         {
             scan_token(lexer);
             Node *expr = parse_binary_expression(lexer);
-            return make_assignment(identifier, expr);
+            return make_assignment(lexer->arena, identifier, expr);
         }
         else if (lexer->current_token.type == TOKEN_LBRACKET)
         {
@@ -231,7 +237,7 @@ Node *parse_expression_statement(Lexer *lexer)
             {
                 scan_token(lexer);
                 Node *expr = parse_binary_expression(lexer);
-                return make_array_assignment(identifier, index, expr);
+                return make_array_assignment(lexer->arena, identifier, index, expr);
             }
             else
             {
@@ -257,13 +263,13 @@ Node *parse_unary_expression(Lexer *lexer)
     {
         scan_token(lexer);
         Node *expr = parse_unary_expression(lexer);
-        return make_address_of(expr);
+        return make_address_of(lexer->arena, expr);
     }
     else if (lexer->current_token.type == TOKEN_STAR)
     {
         scan_token(lexer);
         Node *expr = parse_unary_expression(lexer);
-        return make_dereference(expr);
+        return make_dereference(lexer->arena, expr);
     }
     else
     {
@@ -285,7 +291,7 @@ Node *parse_binary_expression_with_precedence(Lexer *lexer, int precedence)
         scan_token(lexer);
 
         Node *right = parse_binary_expression_with_precedence(lexer, current_precedence + 1);
-        left = make_node(op_type, left, right, 0);
+        left = make_binary(lexer->arena, op_type, left, right);
     }
 
     return left;
@@ -296,19 +302,35 @@ Node *parse_binary_expression(Lexer *lexer)
     return parse_binary_expression_with_precedence(lexer, 0);
 }
 
-char *parse_type(Lexer *lexer)
+Type *type_from_token(TokenType token)
+{
+    switch (token)
+    {
+    case TOKEN_I8:
+        return integer_type(8);
+    case TOKEN_I16:
+        return integer_type(16);
+    case TOKEN_I32:
+        return integer_type(32);
+    case TOKEN_I64:
+        return integer_type(64);
+    default:
+        return void_type();
+    }
+}
+
+Type *parse_type(Lexer *lexer)
 {
     if (!is_type_token(lexer->current_token.type))
     {
         error_report(lexer->line, "Error: Expected type.\n");
         exit(EXIT_FAILURE);
     }
-    char *type_name = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+    Type *type = type_from_token(lexer->current_token.type);
     scan_token(lexer);
     while (lexer->current_token.type == TOKEN_STAR)
     {
-        type_name = realloc(type_name, strlen(type_name) + 2);
-        strcat(type_name, "*");
+        type = pointer_type(type);
         scan_token(lexer);
     }
     if (lexer->current_token.type == TOKEN_LBRACKET)
@@ -317,7 +339,7 @@ char *parse_type(Lexer *lexer)
         int size = -1;
         if (lexer->current_token.type == TOKEN_NUMBER)
         {
-            size = atoi(lexer->current_token.lexeme);
+            size = token_int_value(lexer->current_token);
             scan_token(lexer);
         }
         else
@@ -330,13 +352,15 @@ char *parse_type(Lexer *lexer)
             error_report(lexer->line, "Error: Expected ']' after array size.\n");
             exit(EXIT_FAILURE);
         }
+        if (size <= 0)
+        {
+            error_report(lexer->line, "Error: Invalid array size %d.\n", size);
+            exit(EXIT_FAILURE);
+        }
         scan_token(lexer);
-        char size_str[32];
-        sprintf(size_str, "[%d]", size);
-        type_name = realloc(type_name, strlen(type_name) + strlen(size_str) + 1);
-        strcat(type_name, size_str);
+        type = array_type(type, size);
     }
-    return type_name;
+    return type;
 }
 
 Node *parse_if_statement(Lexer *lexer)
@@ -404,7 +428,7 @@ Node *parse_if_statement(Lexer *lexer)
         scan_token(lexer);
     }
 
-    return make_if_statement(condition, then_branch, else_branch);
+    return make_if_statement(lexer->arena, condition, then_branch, else_branch);
 }
 
 Node *parse_while_statement(Lexer *lexer)
@@ -445,7 +469,7 @@ Node *parse_while_statement(Lexer *lexer)
 
     scan_token(lexer);
 
-    return make_while_statement(condition, body);
+    return make_while_statement(lexer->arena, condition, body);
 }
 
 Node *parse_for_statement(Lexer *lexer)
@@ -511,7 +535,7 @@ Node *parse_for_statement(Lexer *lexer)
     }
     scan_token(lexer);
 
-    return make_for_statement(init, condition, increment, body);
+    return make_for_statement(lexer->arena, init, condition, increment, body);
 }
 
 Node *parse_primary(Lexer *lexer)
@@ -521,11 +545,11 @@ Node *parse_primary(Lexer *lexer)
     if (token.type == TOKEN_NUMBER)
     {
         scan_token(lexer);
-        return make_leaf(AST_NUMBER, atoi(token.lexeme));
+        return make_number(lexer->arena, token_int_value(token));
     }
     else if (token.type == TOKEN_IDENTIFIER)
     {
-        char *identifier = strndup(token.lexeme, token.length);
+        char *identifier = token.name;
         scan_token(lexer);
 
         if (lexer->current_token.type == TOKEN_LPAREN)
@@ -562,7 +586,8 @@ Node *parse_primary(Lexer *lexer)
 
             scan_token(lexer);
 
-            return make_function_call(identifier, arguments, arg_count);
+            arguments = move_nodes_to_arena(lexer->arena, arguments, arg_count);
+            return make_function_call(lexer->arena, identifier, arguments, arg_count);
         }
         else if (lexer->current_token.type == TOKEN_LBRACKET)
         {
@@ -578,11 +603,11 @@ Node *parse_primary(Lexer *lexer)
 
             scan_token(lexer);
 
-            return make_array_access(identifier, index);
+            return make_array_access(lexer->arena, identifier, index);
         }
         else
         {
-            return make_variable_ref(identifier);
+            return make_variable_ref(lexer->arena, identifier);
         }
     }
     else if (token.type == TOKEN_LPAREN)
@@ -601,7 +626,7 @@ Node *parse_primary(Lexer *lexer)
     {
         scan_token(lexer);
 
-        char *cast_type = parse_type(lexer);
+        Type *cast_type = parse_type(lexer);
 
         if (lexer->current_token.type != TOKEN_PIPE)
         {
@@ -612,13 +637,13 @@ Node *parse_primary(Lexer *lexer)
         scan_token(lexer);
 
         Node *expr = parse_primary(lexer);
-        return make_cast(cast_type, expr);
+        return make_cast(lexer->arena, cast_type, expr);
     }
     else if (token.type == TOKEN_MINUS)
     {
         scan_token(lexer);
         Node *expr = parse_primary(lexer);
-        return make_node(AST_NEGATE, expr, NULL, 0);
+        return make_negate(lexer->arena, expr);
     }
     else
     {
@@ -664,7 +689,7 @@ Node *parse_statement(Lexer *lexer)
 
         scan_token(lexer);
 
-        return make_dereference_assignment(dereferenced_expr, value_expr);
+        return make_dereference_assignment(lexer->arena, dereferenced_expr, value_expr);
     }
     else if (lexer->current_token.type == TOKEN_AT)
     {
@@ -676,7 +701,7 @@ Node *parse_statement(Lexer *lexer)
             exit(EXIT_FAILURE);
         }
 
-        char *func_name = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+        char *func_name = lexer->current_token.name;
         scan_token(lexer);
 
         if (lexer->current_token.type != TOKEN_LPAREN)
@@ -692,7 +717,7 @@ Node *parse_statement(Lexer *lexer)
 
         while (lexer->current_token.type != TOKEN_RPAREN)
         {
-            char *param_type = parse_type(lexer);
+            Type *param_type = parse_type(lexer);
 
             if (lexer->current_token.type != TOKEN_COLON)
             {
@@ -708,10 +733,10 @@ Node *parse_statement(Lexer *lexer)
                 exit(EXIT_FAILURE);
             }
 
-            char *param_name = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+            char *param_name = lexer->current_token.name;
             scan_token(lexer);
 
-            Node *param = make_variable_decl(param_type, param_name, NULL);
+            Node *param = make_variable_decl(lexer->arena, param_type, param_name, NULL);
 
             parameters = realloc(parameters, sizeof(Node *) * (param_count + 1));
             parameters[param_count++] = param;
@@ -729,7 +754,7 @@ Node *parse_statement(Lexer *lexer)
 
         scan_token(lexer);
 
-        char *return_type = NULL;
+        Type *return_type = NULL;
         if (lexer->current_token.type == TOKEN_ARROW)
         {
             scan_token(lexer);
@@ -737,6 +762,18 @@ Node *parse_statement(Lexer *lexer)
             return_type = parse_type(lexer);
         }
 
+        parameters = move_nodes_to_arena(lexer->arena, parameters, param_count);
+
+        // `@name(...) -> type;` declares a function defined in another file.
+        if (lexer->current_token.type == TOKEN_SEMI)
+        {
+            scan_token(lexer);
+
+            Node *prototype = make_function_decl(lexer->arena, func_name, parameters, param_count, return_type, NULL);
+            prototype->as.function_decl.is_prototype = 1;
+            return prototype;
+        }
+
         if (lexer->current_token.type != TOKEN_LBRACE)
         {
             error_report(lexer->line, "Error: Expected '{' to start function body.\n");
@@ -755,11 +792,11 @@ Node *parse_statement(Lexer *lexer)
 
         scan_token(lexer);
 
-        return make_function_decl(func_name, parameters, param_count, return_type, body);
+        return make_function_decl(lexer->arena, func_name, parameters, param_count, return_type, body);
     }
     else if (is_type_token(lexer->current_token.type))
     {
-        char *type_name = parse_type(lexer);
+        Type *type = parse_type(lexer);
         if (lexer->current_token.type != TOKEN_COLON)
         {
             error_report(lexer->line, "Error: Expected ':' after type in variable declaration.\n");
@@ -771,7 +808,7 @@ Node *parse_statement(Lexer *lexer)
             error_report(lexer->line, "Error: Expected variable name after ':'.\n");
             exit(EXIT_FAILURE);
         }
-        char *var_name = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+        char *var_name = lexer->current_token.name;
         scan_token(lexer);
         Node *expr = NULL;
         if (lexer->current_token.type == TOKEN_EQUAL)
@@ -802,8 +839,8 @@ Node *parse_statement(Lexer *lexer)
                     exit(EXIT_FAILURE);
                 }
                 scan_token(lexer);
-                Node *array_type_node = make_array_type(type_name, element_count);
-                return make_array_decl(var_name, array_type_node, elements, element_count);
+                elements = move_nodes_to_arena(lexer->arena, elements, element_count);
+                return make_array_decl(lexer->arena, var_name, type, element_count, elements, element_count);
             }
             else
             {
@@ -816,23 +853,30 @@ Node *parse_statement(Lexer *lexer)
             exit(EXIT_FAILURE);
         }
         scan_token(lexer);
-        if (strchr(type_name, '[') != NULL)
+        if (type->kind == TYPE_ARRAY)
         {
-
-            char *bracket_pos = strchr(type_name, '[');
-            int size = atoi(bracket_pos + 1);
-            *bracket_pos = '\0';
-            Node *array_type_node = make_array_type(type_name, size);
-            return make_array_decl(var_name, array_type_node, NULL, 0);
+            return make_array_decl(lexer->arena, var_name, type->element, type->length, NULL, 0);
         }
         else
         {
-            return make_variable_decl(type_name, var_name, expr);
+            return make_variable_decl(lexer->arena, type, var_name, expr);
         }
     }
+    else if (lexer->current_token.type == TOKEN_IDENTIFIER && peek_token(lexer, 1).type == TOKEN_LPAREN)
+    {
+        // A call statement is the call expression followed by ';'.
+        Node *call = parse_primary(lexer);
+        if (lexer->current_token.type != TOKEN_SEMI)
+        {
+            error_report(lexer->line, "Error: Expected ';' after function call.\n");
+            exit(EXIT_FAILURE);
+        }
+        scan_token(lexer);
+        return call;
+    }
     else if (lexer->current_token.type == TOKEN_IDENTIFIER)
     {
-        char *identifier = strndup(lexer->current_token.lexeme, lexer->current_token.length);
+        char *identifier = lexer->current_token.name;
         scan_token(lexer);
 
         if (lexer->current_token.type == TOKEN_EQUAL)
@@ -847,7 +891,7 @@ Node *parse_statement(Lexer *lexer)
             }
 
             scan_token(lexer);
-            return make_assignment(identifier, expr);
+            return make_assignment(lexer->arena, identifier, expr);
         }
         else if (lexer->current_token.type == TOKEN_LBRACKET)
         {
@@ -873,7 +917,7 @@ Node *parse_statement(Lexer *lexer)
                 }
 
                 scan_token(lexer);
-                return make_array_assignment(identifier, index, expr);
+                return make_array_assignment(lexer->arena, identifier, index, expr);
             }
             else
             {
@@ -881,49 +925,6 @@ Node *parse_statement(Lexer *lexer)
                 exit(EXIT_FAILURE);
             }
         }
-        else if (lexer->current_token.type == TOKEN_LPAREN)
-        {
-            scan_token(lexer);
-
-            Node **arguments = NULL;
-            int arg_count = 0;
-
-            if (lexer->current_token.type != TOKEN_RPAREN)
-            {
-                do
-                {
-                    Node *arg = parse_binary_expression(lexer);
-                    arguments = realloc(arguments, sizeof(Node *) * (arg_count + 1));
-                    arguments[arg_count++] = arg;
-
-                    if (lexer->current_token.type == TOKEN_COMMA)
-                    {
-                        scan_token(lexer);
-                    }
-                    else
-                    {
-                        break;
-                    }
-                } while (lexer->current_token.type != TOKEN_RPAREN);
-
-                if (lexer->current_token.type != TOKEN_RPAREN)
-                {
-                    error_report(lexer->line, "Error: Expected ')' after function arguments.\n");
-                    exit(EXIT_FAILURE);
-                }
-            }
-
-            scan_token(lexer);
-
-            if (lexer->current_token.type != TOKEN_SEMI)
-            {
-                error_report(lexer->line, "Error: Expected ';' after function call.\n");
-                exit(EXIT_FAILURE);
-            }
-
-            scan_token(lexer);
-            return make_function_call(identifier, arguments, arg_count);
-        }
         else
         {
             error_report(lexer->line, "Error: Unexpected token after identifier '%s'.\n", identifier);
@@ -944,7 +945,7 @@ Node *parse_statement(Lexer *lexer)
             exit(EXIT_FAILURE);
         }
         scan_token(lexer);
-        return make_return_stmt(expr);
+        return make_return_stmt(lexer->arena, expr);
     }
     else if (lexer->current_token.type == TOKEN_PRINT)
     {
@@ -956,7 +957,7 @@ Node *parse_statement(Lexer *lexer)
             exit(EXIT_FAILURE);
         }
         scan_token(lexer);
-        return make_print(expr);
+        return make_print(lexer->arena, expr);
     }
     else
     {
@@ -968,12 +969,15 @@ Node *parse_statement(Lexer *lexer)
 Node *parse_statement_list(Lexer *lexer)
 {
     Node *list = NULL;
+    Node *tail = NULL;
 
     while (lexer->current_token.type != TOKEN_EOF &&
            lexer->current_token.type != TOKEN_RBRACE)
     {
         Node *stmt = parse_statement(lexer);
-        list = make_statement_list(list, stmt);
+        tail = make_statement_list(lexer->arena, tail, stmt);
+        if (list == NULL)
+            list = tail;
     }
 
     return list;
@@ -1045,90 +1049,3 @@ int get_operator_precedence(NodeType type)
         return -1;
     }
 }
-
-void free_ast(Node *node)
-{
-    if (node == NULL)
-        return;
-
-    switch (node->type)
-    {
-    case AST_ADDRESS_OF:
-    case AST_DEREFERENCE:
-        free_ast(node->expression);
-        break;
-    case AST_PRINT:
-    case AST_RETURN_STMT:
-        free_ast(node->expression);
-        break;
-    case AST_VARIABLE_DECL:
-        free(node->var_type);
-        free(node->var_name);
-        free_ast(node->expression);
-        break;
-    case AST_ARRAY_DECL:
-        free(node->var_type);
-        free(node->var_name);
-        for (int i = 0; i < node->param_count; ++i)
-        {
-            free_ast(node->parameters[i]);
-        }
-        free(node->parameters);
-        break;
-    case AST_ARRAY_ASSIGNMENT:
-        free(node->var_name);
-        free_ast(node->left);
-        free_ast(node->right);
-        break;
-    case AST_IF_STATEMENT:
-        free_ast(node->condition);
-        free_ast(node->then_branch);
-        free_ast(node->else_branch);
-        break;
-    case AST_WHILE_STATEMENT:
-        free_ast(node->condition);
-        free_ast(node->body);
-        break;
-    case AST_FOR_STATEMENT:
-        free_ast(node->init);
-        free_ast(node->condition);
-        free_ast(node->increment);
-        free_ast(node->body);
-        break;
-    case AST_IDENTIFIER:
-        free(node->var_name);
-        break;
-    case AST_FUNCTION_CALL:
-        free(node->func_name);
-        for (int i = 0; i < node->param_count; ++i)
-        {
-            free_ast(node->parameters[i]);
-        }
-        free(node->parameters);
-        break;
-    case AST_FUNCTION_DECL:
-        free(node->func_name);
-        for (int i = 0; i < node->param_count; ++i)
-        {
-            free_ast(node->parameters[i]);
-        }
-        free(node->parameters);
-        free(node->return_type);
-        free_ast(node->body);
-        break;
-    case AST_STATEMENT_LIST:
-        free_ast(node->left);
-        free_ast(node->right);
-        break;
-    case AST_CAST:
-        free(node->cast_type);
-        free_ast(node->expression);
-        break;
-    default:
-        free_ast(node->left);
-        free_ast(node->right);
-        break;
-    }
-
-    free(node);
-}
@@ -4,6 +4,8 @@
 #define AST_H
 
 #include <lexer/lexer.h>
+#include <memory/arena.h>
+#include <types/types.h>
 
 typedef enum
 {
@@ -11,6 +13,7 @@ typedef enum
     AST_MINUS,
     AST_STAR,
     AST_SLASH,
+    AST_SHIFT_LEFT,
 
     AST_EQUAL_EQUAL,
     AST_BANG_EQUAL,
@@ -28,6 +31,7 @@ typedef enum
     AST_RETURN_STMT,
     AST_PRINT,
     AST_STATEMENT_LIST,
+    AST_BLOCK,
     AST_CAST,
     AST_IF_STATEMENT,
     AST_WHILE_STATEMENT,
@@ -37,7 +41,6 @@ typedef enum
     AST_DEREFERENCE,
     AST_DEREFERENCE_ASSIGNMENT,
 
-    AST_ARRAY_TYPE,
     AST_ARRAY_DECL,
     AST_ARRAY_ACCESS,
     AST_ARRAY_ASSIGNMENT,
@@ -50,48 +53,122 @@ typedef struct Node Node;
 struct Node
 {
     NodeType type;
-    Node *left;
-    Node *right;
-    int number_value;
-    char *var_type;
-    char *var_name;
-    Node *expression;
-    char *func_name;
-    Node **parameters;
-    int param_count;
-    Node *body;
-    char *return_type;
-    char *cast_type;
-    Node *condition;
-    Node *then_branch;
-    Node *else_branch;
-    Node *init;
-    Node *increment;
+    union
+    {
+        int number;
+        char *name;
+        Node *operand;
+        struct
+        {
+            Node *left;
+            Node *right;
+        } binary;
+        struct
+        {
+            char *name;
+            Node *value;
+        } assignment;
+        struct
+        {
+            Node *target;
+            Node *value;
+        } dereference_assignment;
+        struct
+        {
+            Type *type;
+            char *name;
+            Node *initializer;
+        } variable_decl;
+        struct
+        {
+            char *name;
+            Type *element_type;
+            int length;
+            int element_count;
+            Node **elements;
+        } array_decl;
+        struct
+        {
+            char *name;
+            Node *index;
+        } array_access;
+        struct
+        {
+            char *name;
+            Node *index;
+            Node *value;
+        } array_assignment;
+        struct
+        {
+            char *name;
+            Node **parameters;
+            int param_count;
+            Type *return_type;
+            Node *body;
+            int is_prototype;
+        } function_decl;
+        struct
+        {
+            char *name;
+            Node **arguments;
+            int arg_count;
+        } function_call;
+        struct
+        {
+            Node *statement;
+            Node *next;
+        } statement_list;
+        struct
+        {
+            Type *type;
+            Node *expression;
+        } cast;
+        struct
+        {
+            Node *condition;
+            Node *then_branch;
+            Node *else_branch;
+        } if_statement;
+        struct
+        {
+            Node *condition;
+            Node *body;
+        } while_statement;
+        struct
+        {
+            Node *init;
+            Node *condition;
+            Node *increment;
+            Node *body;
+        } for_statement;
+    } as;
 };
 
-Node *make_node(NodeType type, Node *left, Node *right, int number_value);
-Node *make_leaf(NodeType type, int number_value);
-Node *make_assignment(char *var_name, Node *expression);
-Node *make_dereference_assignment(Node *dereferenced_expr, Node *value_expr);
-Node *make_array_type(char *element_type, int size);
-Node *make_array_decl(char *var_name, Node *array_type, Node **elements, int element_count);
-Node *make_array_access(char *var_name, Node *index);
-Node *make_array_assignment(char *array_name, Node *index, Node *value);
-Node *make_function_decl(char *func_name, Node **parameters, int param_count, char *return_type, Node *body);
-Node *make_variable_decl(char *var_type, char *var_name, Node *expression);
-Node *make_return_stmt(Node *expression);
-Node *make_print(Node *expression);
-Node *make_variable_ref(char *var_name);
-Node *make_function_call(char *func_name, Node **arguments, int arg_count);
-Node *make_statement_list(Node *list, Node *statement);
-Node *make_cast(char *cast_type, Node *expression);
-Node *make_if_statement(Node *condition, Node *then_branch, Node *else_branch);
-Node *make_while_statement(Node *condition, Node *body);
-Node *make_for_statement(Node *init, Node *condition, Node *increment, Node *body);
-Node *make_address_of(Node *expression);
-Node *make_dereference(Node *expression);
+Node *make_binary(Arena *arena, NodeType type, Node *left, Node *right);
+Node *make_number(Arena *arena, int value);
+Node *make_negate(Arena *arena, Node *operand);
+Node *make_assignment(Arena *arena, char *var_name, Node *expression);
+Node *make_dereference_assignment(Arena *arena, Node *dereferenced_expr, Node *value_expr);
+Node *make_array_decl(Arena *arena, char *var_name, Type *element_type, int length, Node **elements, int element_count);
+Node *make_array_access(Arena *arena, char *var_name, Node *index);
+Node *make_array_assignment(Arena *arena, char *array_name, Node *index, Node *value);
+Node *make_function_decl(Arena *arena, char *func_name, Node **parameters, int param_count, Type *return_type, Node *body);
+Node *make_variable_decl(Arena *arena, Type *var_type, char *var_name, Node *expression);
+Node *make_return_stmt(Arena *arena, Node *expression);
+Node *make_print(Arena *arena, Node *expression);
+Node *make_variable_ref(Arena *arena, char *var_name);
+Node *make_function_call(Arena *arena, char *func_name, Node **arguments, int arg_count);
+Node *make_statement_list(Arena *arena, Node *tail, Node *statement);
+Node *make_cast(Arena *arena, Type *cast_type, Node *expression);
+Node *make_if_statement(Arena *arena, Node *condition, Node *then_branch, Node *else_branch);
+Node *make_while_statement(Arena *arena, Node *condition, Node *body);
+Node *make_for_statement(Arena *arena, Node *init, Node *condition, Node *increment, Node *body);
+Node *make_address_of(Arena *arena, Node *expression);
+Node *make_dereference(Arena *arena, Node *expression);
+Node *make_block(Arena *arena, Node *statements);
 
-char *parse_type(Lexer *lexer);
+Type *type_from_token(TokenType token);
+Type *parse_type(Lexer *lexer);
 Node *parse_if_statement(Lexer *lexer);
 Node *parse_while_statement(Lexer *lexer);
 Node *parse_for_statement(Lexer *lexer);
@@ -106,6 +183,5 @@ NodeType token_to_ast(Lexer *lexer, TokenType token);
 int is_type_token(TokenType token);
 int get_operator_precedence(NodeType type);
 int is_operator(TokenType token);
-void free_ast(Node *node);
 
 #endif // AST_H
@@ -0,0 +1,192 @@
+// parallel_parse.c
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <error.h>
+#include <memory/arena.h>
+#include <parallel/parallel.h>
+#include "parallel_parse.h"
+
+// Below this many tokens per thread, starting threads costs more than it
+// saves.
+#define MIN_TOKENS_PER_RANGE 4096
+
+// A run of whole top-level declarations parsed on one thread into its own
+// arena, as a statement list of its own.
+typedef struct
+{
+    int first_token;
+    int end_token;
+    Arena arena;
+    Node *head;
+    Node *tail;
+    int complete;
+} ParseRange;
+
+typedef struct
+{
+    Lexer *lexer;
+    ParseRange *ranges;
+} ParseContext;
+
+// Returns the index one past the top-level declaration that starts with
+// the '@' at `index`: its ';' for a prototype, otherwise the '}' that
+// balances the body's '{'. Returns -1 for anything else.
+static int skip_declaration(LexedToken *tokens, int count, int index)
+{
+    int i = index + 1;
+    while (i < count && tokens[i].type != TOKEN_LBRACE && tokens[i].type != TOKEN_SEMI &&
+           tokens[i].type != TOKEN_RBRACE && tokens[i].type != TOKEN_AT && tokens[i].type != TOKEN_EOF)
+        i++;
+
+    if (i < count && tokens[i].type == TOKEN_SEMI)
+        return i + 1;
+    if (i >= count || tokens[i].type != TOKEN_LBRACE)
+        return -1;
+
+    int depth = 0;
+    for (; i < count && tokens[i].type != TOKEN_EOF; ++i)
+    {
+        if (tokens[i].type == TOKEN_LBRACE)
+            depth++;
+        else if (tokens[i].type == TOKEN_RBRACE && --depth == 0)
+            return i + 1;
+    }
+    return -1;
+}
+
+// Splits the tokens into at most `jobs` ranges of whole declarations with
+// near-equal token counts. Returns the number of ranges, or 0 when the
+// file is not made only of declarations the pre-scan understands; the
+// parser then sees it sequentially and reports any error as usual.
+static int split_declarations(LexedToken *tokens, int count, int jobs, ParseRange **ranges)
+{
+    int token_total = count - 1;
+    int range_count = token_total / MIN_TOKENS_PER_RANGE;
+    if (range_count > jobs)
+        range_count = jobs;
+    if (range_count < 2)
+        return 0;
+
+    *ranges = calloc(range_count, sizeof(ParseRange));
+    if (!*ranges)
+    {
+        error_report(-1, "Memory allocation failed in split_declarations.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int target = token_total / range_count;
+    int used = 0;
+    int start = 0;
+    int index = 0;
+    while (tokens[index].type != TOKEN_EOF)
+    {
+        if (tokens[index].type != TOKEN_AT)
+            break;
+        index = skip_declaration(tokens, count, index);
+        if (index < 0)
+            break;
+
+        if (index - start >= target && used < range_count - 1)
+        {
+            (*ranges)[used].first_token = start;
+            (*ranges)[used].end_token = index;
+            used++;
+            start = index;
+        }
+    }
+
+    if (index >= 0 && tokens[index].type == TOKEN_EOF && start < index)
+    {
+        (*ranges)[used].first_token = start;
+        (*ranges)[used].end_token = index;
+        used++;
+    }
+
+    if (index < 0 || tokens[index].type != TOKEN_EOF || used < 2)
+    {
+        free(*ranges);
+        *ranges = NULL;
+        return 0;
+    }
+    return used;
+}
+
+static void parse_range(void *context, int index)
+{
+    ParseContext *parse_context = (ParseContext *)context;
+    ParseRange *range = &parse_context->ranges[index];
+    init_arena(&range->arena);
+
+    // A syntax error leaves the range incomplete instead of exiting, so
+    // the error can be reported as a sequential parse would report it.
+    jmp_buf trap;
+    if (setjmp(trap))
+    {
+        set_error_trap(NULL);
+        return;
+    }
+    set_error_trap(&trap);
+
+    // The copy shares the read-only token buffer and allocates its nodes
+    // from this range's arena.
+    Lexer lexer = *parse_context->lexer;
+    lexer.arena = &range->arena;
+    seek_token(&lexer, range->first_token);
+
+    while (lexer.token_index < range->end_token && lexer.current_token.type == TOKEN_AT)
+    {
+        Node *statement = parse_statement(&lexer);
+        range->tail = make_statement_list(&range->arena, range->tail, statement);
+        if (range->head == NULL)
+            range->head = range->tail;
+    }
+    set_error_trap(NULL);
+    range->complete = lexer.token_index == range->end_token;
+}
+
+// Parses a whole pre-tokenized file. With jobs > 1, a brace-matching pass
+// finds the top-level declarations, runs of them are parsed on separate
+// threads, and their statement lists are joined in source order with
+// their nodes moved into lexer->arena. Otherwise, or if a range hits a
+// syntax error or does not end where the pre-scan expected, the file is
+// parsed sequentially, which reports the first error in the file.
+Node *parse_program(Lexer *lexer, int jobs)
+{
+    ParseRange *ranges = NULL;
+    int range_count = 0;
+    if (jobs > 1 && lexer->tokens)
+        range_count = split_declarations(lexer->tokens, lexer->token_count, jobs, &ranges);
+    if (range_count == 0)
+        return parse_statement_list(lexer);
+
+    ParseContext context = {lexer, ranges};
+    parallel_for(range_count, parse_range, &context);
+
+    int complete = 1;
+    for (int i = 0; i < range_count; ++i)
+        complete &= ranges[i].complete;
+
+    Node *program = NULL;
+    if (complete)
+    {
+        program = ranges[0].head;
+        for (int i = 0; i < range_count; ++i)
+        {
+            if (i + 1 < range_count)
+                ranges[i].tail->as.statement_list.next = ranges[i + 1].head;
+            arena_merge(lexer->arena, &ranges[i].arena);
+        }
+        seek_token(lexer, ranges[range_count - 1].end_token);
+    }
+    else
+    {
+        for (int i = 0; i < range_count; ++i)
+            free_arena(&ranges[i].arena);
+        program = parse_statement_list(lexer);
+    }
+
+    free(ranges);
+    return program;
+}
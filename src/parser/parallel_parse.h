@@ -0,0 +1,11 @@
+// parallel_parse.h
+
+#ifndef PARALLEL_PARSE_H
+#define PARALLEL_PARSE_H
+
+#include <lexer/lexer.h>
+#include "ast.h"
+
+Node *parse_program(Lexer *lexer, int jobs);
+
+#endif // PARALLEL_PARSE_H
@@ -0,0 +1,140 @@
+// print.c
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "runtime.h"
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// The longest line is "-9223372036854775808\n".
+#define MAX_LINE_LENGTH 24
+
+static char output_buffer[OUTPUT_BUFFER_SIZE];
+static size_t output_used;
+
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+void syro_flush(void)
+{
+    size_t written = 0;
+    while (written < output_used)
+    {
+        ssize_t result = write(STDOUT_FILENO, output_buffer + written, output_used - written);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            break;
+        written += (size_t)result;
+    }
+    output_used = 0;
+}
+
+__attribute__((destructor)) static void flush_at_exit(void)
+{
+    syro_flush();
+}
+
+static char *reserve_line(void)
+{
+    if (output_used + MAX_LINE_LENGTH > OUTPUT_BUFFER_SIZE)
+        syro_flush();
+    return output_buffer + output_used;
+}
+
+// Digits are produced two at a time from the back of a scratch buffer, so
+// each pair costs one division by a constant.
+static void print_decimal(uint64_t magnitude, int negative)
+{
+    char digits[20];
+    char *end = digits + sizeof(digits);
+    char *start = end;
+
+    while (magnitude >= 100)
+    {
+        unsigned pair = (unsigned)(magnitude % 100) * 2;
+        magnitude /= 100;
+        start -= 2;
+        memcpy(start, digit_pairs + pair, 2);
+    }
+    if (magnitude >= 10)
+    {
+        start -= 2;
+        memcpy(start, digit_pairs + magnitude * 2, 2);
+    }
+    else
+    {
+        *--start = (char)('0' + magnitude);
+    }
+
+    char *out = reserve_line();
+    if (negative)
+        *out++ = '-';
+    size_t length = (size_t)(end - start);
+    memcpy(out, start, length);
+    out[length] = '\n';
+    output_used = (size_t)(out + length + 1 - output_buffer);
+}
+
+void syro_print_i64(int64_t value)
+{
+    if (value < 0)
+        print_decimal(0 - (uint64_t)value, 1);
+    else
+        print_decimal((uint64_t)value, 0);
+}
+
+void syro_print_i32(int32_t value)
+{
+    syro_print_i64(value);
+}
+
+void syro_print_i16(int16_t value)
+{
+    syro_print_i64(value);
+}
+
+void syro_print_i8(int8_t value)
+{
+    syro_print_i64(value);
+}
+
+// Matches glibc's "%p": lowercase hex with a 0x prefix, "(nil)" for NULL.
+void syro_print_ptr(const void *value)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    char *out = reserve_line();
+    uintptr_t address = (uintptr_t)value;
+    if (!address)
+    {
+        memcpy(out, "(nil)\n", 6);
+        output_used += 6;
+        return;
+    }
+
+    char digits[2 * sizeof(uintptr_t)];
+    char *end = digits + sizeof(digits);
+    char *start = end;
+    while (address)
+    {
+        *--start = hex_digits[address & 0xf];
+        address >>= 4;
+    }
+
+    size_t length = (size_t)(end - start);
+    out[0] = '0';
+    out[1] = 'x';
+    memcpy(out + 2, start, length);
+    out[2 + length] = '\n';
+    output_used += 3 + length;
+}
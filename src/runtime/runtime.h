@@ -0,0 +1,21 @@
+// runtime.h
+
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stdint.h>
+
+// Runtime support called by generated code. Each print routine formats its
+// value and a newline into a process-wide buffer that is written to stdout
+// when full, on syro_flush() and at exit. Not thread-safe.
+//
+// Executables are linked against libsyrort.a; --run resolves the same
+// functions inside syroc.
+void syro_print_i8(int8_t value);
+void syro_print_i16(int16_t value);
+void syro_print_i32(int32_t value);
+void syro_print_i64(int64_t value);
+void syro_print_ptr(const void *value);
+void syro_flush(void);
+
+#endif // RUNTIME_H
@@ -3,9 +3,65 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "symbol_table.h"
 #include "error.h"
 
+#define INITIAL_SLOT_CAPACITY 64
+#define INITIAL_SYMBOL_CAPACITY 32
+#define INITIAL_SCOPE_CAPACITY 8
+
+static unsigned int hash_name(const char *name)
+{
+    uintptr_t address = (uintptr_t)name;
+    return (unsigned int)((address >> 3) * 2654435761u);
+}
+
+static void *checked_realloc(void *memory, size_t size, const char *function)
+{
+    void *result = realloc(memory, size);
+    if (!result)
+    {
+        error_report(-1, "Memory allocation failed in %s.\n", function);
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+static int *find_slot(SymbolTable *table, const char *name)
+{
+    unsigned int mask = (unsigned int)table->slot_capacity - 1;
+    unsigned int index = hash_name(name) & mask;
+    for (;;)
+    {
+        int *slot = &table->slots[index];
+        if (*slot < 0 || table->symbols[*slot].name == name)
+            return slot;
+        index = (index + 1) & mask;
+    }
+}
+
+static void bind_slot(SymbolTable *table, int symbol_index)
+{
+    int *slot = find_slot(table, table->symbols[symbol_index].name);
+    if (*slot < 0)
+        table->slot_count++;
+    *slot = symbol_index;
+}
+
+static void grow_slots(SymbolTable *table)
+{
+    table->slot_capacity *= 2;
+    table->slots = checked_realloc(table->slots, sizeof(int) * table->slot_capacity, "grow_slots");
+    memset(table->slots, 0xff, sizeof(int) * table->slot_capacity);
+    table->slot_count = 0;
+
+    // Replaying declarations in order rebuilds the same probe chains that
+    // incremental insertion produced, which pop_scope depends on.
+    for (int i = 0; i < table->symbol_count; ++i)
+        bind_slot(table, i);
+}
+
 SymbolTable *create_symbol_table()
 {
     SymbolTable *table = (SymbolTable *)malloc(sizeof(SymbolTable));
@@ -14,51 +70,99 @@ SymbolTable *create_symbol_table()
         error_report(-1, "Memory allocation failed in create_symbol_table.\n");
         exit(EXIT_FAILURE);
     }
-    table->head = NULL;
+
+    table->slot_capacity = INITIAL_SLOT_CAPACITY;
+    table->slot_count = 0;
+    table->slots = checked_realloc(NULL, sizeof(int) * table->slot_capacity, "create_symbol_table");
+    memset(table->slots, 0xff, sizeof(int) * table->slot_capacity);
+
+    table->symbol_capacity = INITIAL_SYMBOL_CAPACITY;
+    table->symbol_count = 0;
+    table->symbols = checked_realloc(NULL, sizeof(Symbol) * table->symbol_capacity, "create_symbol_table");
+
+    table->scope_capacity = INITIAL_SCOPE_CAPACITY;
+    table->scope_count = 1;
+    table->scope_starts = checked_realloc(NULL, sizeof(int) * table->scope_capacity, "create_symbol_table");
+    table->scope_starts[0] = 0;
+
     return table;
 }
 
-void add_symbol(SymbolTable *table, char *name, LLVMValueRef value)
+void push_scope(SymbolTable *table)
 {
-    if (get_symbol(table, name))
+    if (table->scope_count == table->scope_capacity)
     {
-        error_report(-1, "Symbol '%s' already defined.\n", name);
+        table->scope_capacity *= 2;
+        table->scope_starts = checked_realloc(table->scope_starts, sizeof(int) * table->scope_capacity, "push_scope");
+    }
+    table->scope_starts[table->scope_count++] = table->symbol_count;
+}
+
+void pop_scope(SymbolTable *table)
+{
+    if (table->scope_count <= 1)
+    {
+        error_report(-1, "Cannot pop the outermost scope.\n");
         exit(EXIT_FAILURE);
     }
 
-    Symbol *symbol = (Symbol *)malloc(sizeof(Symbol));
-    if (!symbol)
+    int scope_start = table->scope_starts[--table->scope_count];
+    while (table->symbol_count > scope_start)
     {
-        error_report(-1, "Memory allocation failed in add_symbol.\n");
+        Symbol *symbol = &table->symbols[--table->symbol_count];
+        int *slot = find_slot(table, symbol->name);
+        *slot = symbol->shadowed;
+        if (symbol->shadowed < 0)
+            table->slot_count--;
+    }
+}
+
+void add_symbol(SymbolTable *table, char *name, LLVMValueRef value, int is_ssa)
+{
+    if ((table->slot_count + 1) * 2 > table->slot_capacity)
+        grow_slots(table);
+
+    int *slot = find_slot(table, name);
+    int scope_start = table->scope_starts[table->scope_count - 1];
+    if (*slot >= scope_start)
+    {
+        error_report(-1, "Symbol '%s' already defined.\n", name);
         exit(EXIT_FAILURE);
     }
-    symbol->name = strdup(name);
+
+    if (table->symbol_count == table->symbol_capacity)
+    {
+        table->symbol_capacity *= 2;
+        table->symbols = checked_realloc(table->symbols, sizeof(Symbol) * table->symbol_capacity, "add_symbol");
+    }
+
+    int index = table->symbol_count++;
+    Symbol *symbol = &table->symbols[index];
+    symbol->name = name;
     symbol->value = value;
-    symbol->next = table->head;
-    table->head = symbol;
+    symbol->is_ssa = is_ssa;
+    symbol->shadowed = *slot;
+
+    if (*slot < 0)
+        table->slot_count++;
+    *slot = index;
+}
+
+int find_symbol(SymbolTable *table, char *name)
+{
+    return *find_slot(table, name);
 }
 
 LLVMValueRef get_symbol(SymbolTable *table, char *name)
 {
-    Symbol *current = table->head;
-    while (current)
-    {
-        if (strcmp(current->name, name) == 0)
-            return current->value;
-        current = current->next;
-    }
-    return NULL;
+    int index = *find_slot(table, name);
+    return index >= 0 ? table->symbols[index].value : NULL;
 }
 
 void free_symbol_table(SymbolTable *table)
 {
-    Symbol *current = table->head;
-    while (current)
-    {
-        Symbol *temp = current;
-        current = current->next;
-        free(temp->name);
-        free(temp);
-    }
+    free(table->slots);
+    free(table->symbols);
+    free(table->scope_starts);
     free(table);
 }
@@ -5,21 +5,43 @@
 
 #include <llvm-c/Core.h>
 
-typedef struct Symbol
+// A symbol is either a stack slot (`value` is its alloca) or, with direct
+// SSA construction, a register whose `value` is the current definition.
+typedef struct
 {
     char *name;
     LLVMValueRef value;
-    struct Symbol *next;
+    int is_ssa;
+    int shadowed;
 } Symbol;
 
+// Open-addressing table mapping each visible name to the index of its
+// innermost declaration in `symbols`. Declarations are kept in a stack so
+// pop_scope can unwind them in reverse order and restore shadowed entries.
+// Names must be interned (see lexer/intern.h): they are hashed and compared
+// by pointer, and are not copied.
 typedef struct
 {
-    Symbol *head;
+    int *slots;
+    int slot_capacity;
+    int slot_count;
+    Symbol *symbols;
+    int symbol_count;
+    int symbol_capacity;
+    int *scope_starts;
+    int scope_count;
+    int scope_capacity;
 } SymbolTable;
 
 SymbolTable *create_symbol_table();
 
-void add_symbol(SymbolTable *table, char *name, LLVMValueRef value);
+void push_scope(SymbolTable *table);
+
+void pop_scope(SymbolTable *table);
+
+void add_symbol(SymbolTable *table, char *name, LLVMValueRef value, int is_ssa);
+
+int find_symbol(SymbolTable *table, char *name);
 
 LLVMValueRef get_symbol(SymbolTable *table, char *name);
 
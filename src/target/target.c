@@ -0,0 +1,240 @@
+// target.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/TargetMachine.h>
+#include "target.h"
+
+extern char **environ;
+
+static LLVMCodeGenOptLevel to_codegen_opt_level(int opt_level)
+{
+    switch (opt_level)
+    {
+    case 0:
+        return LLVMCodeGenLevelNone;
+    case 1:
+        return LLVMCodeGenLevelLess;
+    case 2:
+        return LLVMCodeGenLevelDefault;
+    default:
+        return LLVMCodeGenLevelAggressive;
+    }
+}
+
+LLVMTargetMachineRef create_host_target_machine(int opt_level)
+{
+    if (LLVMInitializeNativeTarget() || LLVMInitializeNativeAsmPrinter())
+    {
+        fprintf(stderr, "Error: Failed to initialize the native target.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char *triple = LLVMGetDefaultTargetTriple();
+    LLVMTargetRef target;
+    char *error = NULL;
+    if (LLVMGetTargetFromTriple(triple, &target, &error))
+    {
+        fprintf(stderr, "Error: Failed to look up target '%s': %s\n", triple, error);
+        LLVMDisposeMessage(error);
+        LLVMDisposeMessage(triple);
+        exit(EXIT_FAILURE);
+    }
+
+    char *cpu = LLVMGetHostCPUName();
+    char *features = LLVMGetHostCPUFeatures();
+
+    LLVMTargetMachineRef target_machine = LLVMCreateTargetMachine(
+        target,
+        triple,
+        cpu,
+        features,
+        to_codegen_opt_level(opt_level),
+        LLVMRelocPIC,
+        LLVMCodeModelDefault);
+
+    LLVMDisposeMessage(features);
+    LLVMDisposeMessage(cpu);
+    LLVMDisposeMessage(triple);
+
+    if (!target_machine)
+    {
+        fprintf(stderr, "Error: Failed to create target machine.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return target_machine;
+}
+
+void configure_module_for_target(LLVMModuleRef module, LLVMTargetMachineRef target_machine)
+{
+    char *triple = LLVMGetTargetMachineTriple(target_machine);
+    LLVMSetTarget(module, triple);
+    LLVMDisposeMessage(triple);
+
+    LLVMTargetDataRef data_layout = LLVMCreateTargetDataLayout(target_machine);
+    char *layout = LLVMCopyStringRepOfTargetData(data_layout);
+    LLVMSetDataLayout(module, layout);
+    LLVMDisposeMessage(layout);
+    LLVMDisposeTargetData(data_layout);
+}
+
+void emit_object_file(LLVMModuleRef module, LLVMTargetMachineRef target_machine, const char *path)
+{
+    char *error = NULL;
+    if (LLVMTargetMachineEmitToFile(target_machine, module, (char *)path, LLVMObjectFile, &error))
+    {
+        fprintf(stderr, "Error: Failed to write object file '%s': %s\n", path, error);
+        LLVMDisposeMessage(error);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void emit_bitcode_file(LLVMModuleRef module, const char *path)
+{
+    if (LLVMWriteBitcodeToFile(module, path) != 0)
+    {
+        fprintf(stderr, "Error: Failed to write bitcode file '%s'.\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Loads a module previously written with --emit=bc. The file is read
+// through an LLVM memory buffer, which maps large files instead of copying.
+LLVMModuleRef read_bitcode_file(LLVMContextRef context, const char *path)
+{
+    LLVMMemoryBufferRef bitcode;
+    char *error = NULL;
+    if (LLVMCreateMemoryBufferWithContentsOfFile(path, &bitcode, &error))
+    {
+        fprintf(stderr, "Error: Could not open file %s: %s\n", path, error);
+        LLVMDisposeMessage(error);
+        exit(EXIT_FAILURE);
+    }
+
+    LLVMModuleRef module;
+    if (LLVMParseBitcodeInContext2(context, bitcode, &module))
+    {
+        fprintf(stderr, "Error: '%s' is not a valid LLVM bitcode file.\n", path);
+        exit(EXIT_FAILURE);
+    }
+    LLVMDisposeMemoryBuffer(bitcode);
+    return module;
+}
+
+// Returns a fresh, empty file in $TMPDIR (or /tmp) for an intermediate
+// object. The caller unlinks and frees it.
+char *create_temporary_object_path(void)
+{
+    const char *tmp_dir = getenv("TMPDIR");
+    if (!tmp_dir || !*tmp_dir)
+        tmp_dir = "/tmp";
+
+    size_t size = strlen(tmp_dir) + sizeof("/syroc-XXXXXX.o");
+    char *path = malloc(size);
+    if (!path)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in create_temporary_object_path.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, size, "%s/syroc-XXXXXX.o", tmp_dir);
+
+    int fd = mkstemps(path, 2);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Error: Could not create temporary object file in %s.\n", tmp_dir);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    return path;
+}
+
+// The print runtime is archived next to the syroc binary by the build;
+// $SYROC_RUNTIME overrides the location.
+static char *runtime_library_path(void)
+{
+    const char *override = getenv("SYROC_RUNTIME");
+    if (override && *override)
+        return strdup(override);
+
+    char executable[4096];
+    ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    if (length < 0)
+    {
+        fprintf(stderr, "Error: Could not locate the syroc executable to find libsyrort.a; set SYROC_RUNTIME.\n");
+        return NULL;
+    }
+    executable[length] = '\0';
+
+    char *slash = strrchr(executable, '/');
+    size_t directory_length = slash ? (size_t)(slash - executable) : 0;
+    size_t size = directory_length + sizeof("/libsyrort.a");
+    char *path = malloc(size);
+    if (!path)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in runtime_library_path.\n");
+        exit(EXIT_FAILURE);
+    }
+    snprintf(path, size, "%.*s/libsyrort.a", (int)directory_length, executable);
+
+    if (access(path, R_OK) != 0)
+    {
+        fprintf(stderr, "Error: Runtime library %s not found; set SYROC_RUNTIME.\n", path);
+        free(path);
+        return NULL;
+    }
+    return path;
+}
+
+// Links the objects and the runtime library into an executable. Returns 0
+// on success, or -1 after reporting why the link failed, so the caller can
+// still remove its temporary objects.
+int link_executable(const char **object_paths, int object_count, const char *output_path)
+{
+    const char *linker = getenv("SYROC_LINKER");
+    if (!linker || !*linker)
+        linker = "cc";
+
+    char *runtime_library = runtime_library_path();
+    if (!runtime_library)
+        return -1;
+    char **args = malloc(sizeof(char *) * (object_count + 5));
+    if (!args)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in link_executable.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int arg_count = 0;
+    args[arg_count++] = (char *)linker;
+    for (int i = 0; i < object_count; ++i)
+        args[arg_count++] = (char *)object_paths[i];
+    args[arg_count++] = runtime_library;
+    args[arg_count++] = "-o";
+    args[arg_count++] = (char *)output_path;
+    args[arg_count] = NULL;
+
+    pid_t pid;
+    int status = posix_spawnp(&pid, linker, NULL, NULL, args, environ);
+    free(args);
+    free(runtime_library);
+    if (status != 0)
+    {
+        fprintf(stderr, "Error: Failed to run linker '%s': %s\n", linker, strerror(status));
+        return -1;
+    }
+
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Error: Linking '%s' failed.\n", output_path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+// target.h
+
+#ifndef TARGET_H
+#define TARGET_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+
+LLVMTargetMachineRef create_host_target_machine(int opt_level);
+void configure_module_for_target(LLVMModuleRef module, LLVMTargetMachineRef target_machine);
+void emit_object_file(LLVMModuleRef module, LLVMTargetMachineRef target_machine, const char *path);
+void emit_bitcode_file(LLVMModuleRef module, const char *path);
+LLVMModuleRef read_bitcode_file(LLVMContextRef context, const char *path);
+char *create_temporary_object_path(void);
+int link_executable(const char **object_paths, int object_count, const char *output_path);
+
+#endif // TARGET_H
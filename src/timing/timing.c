@@ -0,0 +1,134 @@
+// timing.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "timing.h"
+#include "memory/arena.h"
+
+static double clock_ms(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+static long peak_rss_kb(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void init_time_report(TimeReport *report, TimeReportFormat format)
+{
+    report->format = format;
+    report->phase_count = 0;
+    report->current_phase = NULL;
+}
+
+static PhaseTiming *find_phase(TimeReport *report, const char *name)
+{
+    for (int i = 0; i < report->phase_count; ++i)
+    {
+        if (strcmp(report->phases[i].name, name) == 0)
+            return &report->phases[i];
+    }
+    return NULL;
+}
+
+// A phase entered more than once, such as parsing each input file, is
+// reported as a single entry accumulating every run.
+void begin_phase(TimeReport *report, const char *name)
+{
+    if (report->format == TIME_REPORT_NONE)
+        return;
+
+    PhaseTiming *phase = find_phase(report, name);
+    if (!phase)
+    {
+        if (report->phase_count == MAX_PHASES)
+        {
+            report->current_phase = NULL;
+            return;
+        }
+        phase = &report->phases[report->phase_count++];
+        memset(phase, 0, sizeof(*phase));
+        phase->name = name;
+    }
+
+    report->current_phase = phase;
+    arena_statistics(&report->phase_start_allocations, &report->phase_start_bytes);
+    report->phase_start_cpu = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+    report->phase_start_wall = clock_ms(CLOCK_MONOTONIC);
+}
+
+void end_phase(TimeReport *report)
+{
+    if (report->format == TIME_REPORT_NONE || !report->current_phase)
+        return;
+
+    double wall = clock_ms(CLOCK_MONOTONIC);
+    double cpu = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+    size_t allocations, bytes;
+    arena_statistics(&allocations, &bytes);
+
+    PhaseTiming *phase = report->current_phase;
+    phase->wall_ms += wall - report->phase_start_wall;
+    phase->cpu_ms += cpu - report->phase_start_cpu;
+    phase->peak_rss_kb = peak_rss_kb();
+    phase->allocations += allocations - report->phase_start_allocations;
+    phase->allocated_bytes += bytes - report->phase_start_bytes;
+    report->current_phase = NULL;
+}
+
+static void print_table(TimeReport *report, FILE *out)
+{
+    double total_wall = 0, total_cpu = 0;
+    size_t total_allocations = 0, total_bytes = 0;
+
+    fprintf(out, "===== syroc time report =====\n");
+    fprintf(out, "%-12s %10s %10s %6s %14s %12s %14s\n",
+            "phase", "wall ms", "cpu ms", "wall%", "peak RSS KB", "allocs", "alloc bytes");
+
+    for (int i = 0; i < report->phase_count; ++i)
+        total_wall += report->phases[i].wall_ms;
+
+    for (int i = 0; i < report->phase_count; ++i)
+    {
+        PhaseTiming *phase = &report->phases[i];
+        fprintf(out, "%-12s %10.3f %10.3f %5.1f%% %14ld %12zu %14zu\n",
+                phase->name, phase->wall_ms, phase->cpu_ms,
+                total_wall > 0 ? 100.0 * phase->wall_ms / total_wall : 0.0,
+                phase->peak_rss_kb, phase->allocations, phase->allocated_bytes);
+        total_cpu += phase->cpu_ms;
+        total_allocations += phase->allocations;
+        total_bytes += phase->allocated_bytes;
+    }
+
+    fprintf(out, "%-12s %10.3f %10.3f %5.1f%% %14ld %12zu %14zu\n",
+            "total", total_wall, total_cpu, 100.0, peak_rss_kb(), total_allocations, total_bytes);
+}
+
+static void print_json(TimeReport *report, FILE *out)
+{
+    fprintf(out, "{\"phases\":[");
+    for (int i = 0; i < report->phase_count; ++i)
+    {
+        PhaseTiming *phase = &report->phases[i];
+        fprintf(out, "%s{\"name\":\"%s\",\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"peak_rss_kb\":%ld,\"allocations\":%zu,\"allocated_bytes\":%zu}",
+                i ? "," : "", phase->name, phase->wall_ms, phase->cpu_ms,
+                phase->peak_rss_kb, phase->allocations, phase->allocated_bytes);
+    }
+    fprintf(out, "],\"peak_rss_kb\":%ld}\n", peak_rss_kb());
+}
+
+void print_time_report(TimeReport *report, FILE *out)
+{
+    if (report->format == TIME_REPORT_TABLE)
+        print_table(report, out);
+    else if (report->format == TIME_REPORT_JSON)
+        print_json(report, out);
+}
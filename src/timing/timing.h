@@ -0,0 +1,45 @@
+// timing.h
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define MAX_PHASES 32
+
+typedef enum
+{
+    TIME_REPORT_NONE,
+    TIME_REPORT_TABLE,
+    TIME_REPORT_JSON,
+} TimeReportFormat;
+
+typedef struct
+{
+    const char *name;
+    double wall_ms;
+    double cpu_ms;
+    long peak_rss_kb;
+    size_t allocations;
+    size_t allocated_bytes;
+} PhaseTiming;
+
+typedef struct
+{
+    TimeReportFormat format;
+    PhaseTiming phases[MAX_PHASES];
+    int phase_count;
+    PhaseTiming *current_phase;
+    double phase_start_wall;
+    double phase_start_cpu;
+    size_t phase_start_allocations;
+    size_t phase_start_bytes;
+} TimeReport;
+
+void init_time_report(TimeReport *report, TimeReportFormat format);
+void begin_phase(TimeReport *report, const char *name);
+void end_phase(TimeReport *report);
+void print_time_report(TimeReport *report, FILE *out);
+
+#endif // TIMING_H
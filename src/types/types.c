@@ -0,0 +1,140 @@
+// types.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "types.h"
+#include "error.h"
+#include "memory/arena.h"
+
+// Types are created while parsing, which may run on several threads; the
+// lock covers every change to the type graph.
+static pthread_mutex_t type_lock = PTHREAD_MUTEX_INITIALIZER;
+static Arena type_arena;
+static int initialized = 0;
+static int next_type_id = 0;
+
+static Type *builtin_void;
+static Type *builtin_i8;
+static Type *builtin_i16;
+static Type *builtin_i32;
+static Type *builtin_i64;
+
+static Type *new_type(TypeKind kind)
+{
+    Type *type = (Type *)arena_alloc(&type_arena, sizeof(Type));
+    type->kind = kind;
+    type->id = next_type_id++;
+    type->width = 0;
+    type->length = 0;
+    type->pointee = NULL;
+    type->element = NULL;
+    type->pointer_to = NULL;
+    type->arrays_of = NULL;
+    type->next_array = NULL;
+    return type;
+}
+
+static Type *new_integer_type(int width)
+{
+    Type *type = new_type(TYPE_INTEGER);
+    type->width = width;
+    return type;
+}
+
+static void init_types(void)
+{
+    if (__atomic_load_n(&initialized, __ATOMIC_ACQUIRE))
+        return;
+
+    pthread_mutex_lock(&type_lock);
+    if (!initialized)
+    {
+        init_arena(&type_arena);
+        builtin_void = new_type(TYPE_VOID);
+        builtin_i8 = new_integer_type(8);
+        builtin_i16 = new_integer_type(16);
+        builtin_i32 = new_integer_type(32);
+        builtin_i64 = new_integer_type(64);
+        __atomic_store_n(&initialized, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&type_lock);
+}
+
+Type *void_type(void)
+{
+    init_types();
+    return builtin_void;
+}
+
+Type *integer_type(int width)
+{
+    init_types();
+    switch (width)
+    {
+    case 8:
+        return builtin_i8;
+    case 16:
+        return builtin_i16;
+    case 32:
+        return builtin_i32;
+    case 64:
+        return builtin_i64;
+    default:
+        error_report(-1, "Unsupported integer width %d.\n", width);
+        exit(EXIT_FAILURE);
+    }
+}
+
+Type *pointer_type(Type *pointee)
+{
+    pthread_mutex_lock(&type_lock);
+    if (!pointee->pointer_to)
+    {
+        Type *type = new_type(TYPE_POINTER);
+        type->pointee = pointee;
+        pointee->pointer_to = type;
+    }
+    Type *type = pointee->pointer_to;
+    pthread_mutex_unlock(&type_lock);
+    return type;
+}
+
+Type *array_type(Type *element, int length)
+{
+    if (length <= 0)
+    {
+        error_report(-1, "Invalid array size %d.\n", length);
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_lock(&type_lock);
+    Type *type = element->arrays_of;
+    while (type && type->length != length)
+        type = type->next_array;
+
+    if (!type)
+    {
+        type = new_type(TYPE_ARRAY);
+        type->element = element;
+        type->length = length;
+        type->next_array = element->arrays_of;
+        element->arrays_of = type;
+    }
+    pthread_mutex_unlock(&type_lock);
+    return type;
+}
+
+int type_count(void)
+{
+    return next_type_id;
+}
+
+void free_types(void)
+{
+    if (!initialized)
+        return;
+    free_arena(&type_arena);
+    initialized = 0;
+    next_type_id = 0;
+}
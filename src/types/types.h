@@ -0,0 +1,38 @@
+// types.h
+
+#ifndef TYPES_H
+#define TYPES_H
+
+typedef enum
+{
+    TYPE_VOID,
+    TYPE_INTEGER,
+    TYPE_POINTER,
+    TYPE_ARRAY,
+} TypeKind;
+
+typedef struct Type Type;
+
+// Types are interned: structurally equal types share one Type object, so
+// they can be compared by pointer and keyed by their dense id.
+struct Type
+{
+    TypeKind kind;
+    int id;
+    int width;
+    int length;
+    Type *pointee;
+    Type *element;
+    Type *pointer_to;
+    Type *arrays_of;
+    Type *next_array;
+};
+
+Type *void_type(void);
+Type *integer_type(int width);
+Type *pointer_type(Type *pointee);
+Type *array_type(Type *element, int length);
+int type_count(void);
+void free_types(void);
+
+#endif // TYPES_H
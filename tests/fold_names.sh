@@ -0,0 +1,73 @@
+#!/bin/sh
+# fold_names.sh
+#
+# Constant folding drops the x of x*0 and the dead branch of a constant
+# if. Each program below uses an undefined name only in such a subtree,
+# and must still fail to compile with the error codegen reports for it.
+#
+# Usage: tests/fold_names.sh [syroc]
+
+SYROC=${1:-build/syroc}
+
+if [ ! -x "$SYROC" ]; then
+    echo "syroc not found at $SYROC; run 'make' first" >&2
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+FAILED=0
+
+# expect_error <name> <expected message>, with the program on stdin.
+expect_error()
+{
+    cat > "$WORK_DIR/$1.syro"
+    if "$SYROC" "$WORK_DIR/$1.syro" > /dev/null 2> "$WORK_DIR/$1.err"; then
+        echo "FAIL $1: compiled, expected \"$2\""
+        FAILED=1
+    elif ! grep -qF "$2" "$WORK_DIR/$1.err"; then
+        echo "FAIL $1: expected \"$2\", got:"
+        cat "$WORK_DIR/$1.err"
+        FAILED=1
+    else
+        echo "ok   $1"
+    fi
+}
+
+expect_error multiply_undefined "Undefined variable 'nope'" <<'SYRO'
+@main() -> i32 {
+    print(nope * 0);
+    return 0;
+}
+SYRO
+
+expect_error multiply_undefined_array "Undefined array 'arr'" <<'SYRO'
+@main() -> i32 {
+    print(arr[3] * 0);
+    return 0;
+}
+SYRO
+
+expect_error dead_branch_variable "Undefined variable 'missing'" <<'SYRO'
+@main() -> i32 {
+    if (1 > 2) { print(missing); undefined_fn(3); }
+    return 0;
+}
+SYRO
+
+expect_error dead_branch_function "Function 'undefined_fn' not found" <<'SYRO'
+@main() -> i32 {
+    if (1 > 2) { undefined_fn(3); }
+    return 0;
+}
+SYRO
+
+expect_error dead_else_branch "Undefined variable 'missing'" <<'SYRO'
+@main() -> i32 {
+    if (1) { print(1); } else { i32: x = missing; }
+    return 0;
+}
+SYRO
+
+exit $FAILED